@@ -0,0 +1,149 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Выделение памяти под элементы векторов: выравнивание по строке кэша
+// и большие страницы (2 МиБ) для больших буферов
+//
+//
+
+#ifndef __TAlloc_H__
+#define __TAlloc_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+const size_t ALLOC_ALIGNMENT = 64;
+const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+// Большие страницы для буферов от HUGE_PAGE_SIZE:
+//  HUGE_PAGES_OFF - не используются;
+//  HUGE_PAGES_ADVISE - буфер выравнивается на 2 МиБ и помечается
+//    madvise(MADV_HUGEPAGE) для прозрачных больших страниц;
+//  HUGE_PAGES_EXPLICIT - сначала mmap(MAP_HUGETLB) из заранее выделенного
+//    системой пула, при неудаче - как HUGE_PAGES_ADVISE
+enum THugePageMode { HUGE_PAGES_OFF, HUGE_PAGES_ADVISE, HUGE_PAGES_EXPLICIT };
+
+// режим читается при каждом выделении, в том числе из параллельных циклов
+inline std::atomic<THugePageMode>& HugePageMode()
+{
+  static std::atomic<THugePageMode> mode(HUGE_PAGES_ADVISE);
+  return mode;
+}
+
+inline void SetHugePageMode(THugePageMode mode)
+{
+  HugePageMode() = mode;
+}
+
+// служебный заголовок непосредственно перед выданным указателем
+struct TAllocHeader
+{
+  void* base;
+  size_t length; // 0 - память из malloc, иначе длина отображения mmap
+};
+
+inline size_t AlignUp(size_t x, size_t a)
+{
+  return (x + a - 1) / a * a;
+}
+
+// Память под bytes байт, выровненная по ALLOC_ALIGNMENT
+inline void* AlignedAlloc(size_t bytes)
+{
+  const size_t head = AlignUp(sizeof(TAllocHeader), ALLOC_ALIGNMENT);
+#if defined(__linux__)
+  const THugePageMode mode = HugePageMode();
+  if (mode != HUGE_PAGES_OFF && bytes >= HUGE_PAGE_SIZE)
+  {
+    size_t len = AlignUp(bytes + head, HUGE_PAGE_SIZE);
+    char* base = (char*)MAP_FAILED;
+    char* start = nullptr;
+#if defined(MAP_HUGETLB)
+    if (mode == HUGE_PAGES_EXPLICIT)
+    {
+      base = (char*)mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      start = base;
+    }
+#endif
+    if (base == (char*)MAP_FAILED)
+    {
+      // запас на выравнивание начала на границу большой страницы
+      len += HUGE_PAGE_SIZE;
+      base = (char*)mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (base != (char*)MAP_FAILED)
+      {
+        start = (char*)AlignUp((size_t)base, HUGE_PAGE_SIZE);
+#if defined(MADV_HUGEPAGE)
+        madvise(start, len - (size_t)(start - base), MADV_HUGEPAGE);
+#endif
+      }
+    }
+    if (base != (char*)MAP_FAILED)
+    {
+      char* p = start + head;
+      TAllocHeader* h = (TAllocHeader*)p - 1;
+      h->base = base;
+      h->length = len;
+      return p;
+    }
+  }
+#endif
+  char* base = (char*)std::malloc(bytes + head + ALLOC_ALIGNMENT);
+  if (base == nullptr)
+    throw std::bad_alloc();
+  char* p = (char*)AlignUp((size_t)base + sizeof(TAllocHeader), ALLOC_ALIGNMENT);
+  TAllocHeader* h = (TAllocHeader*)p - 1;
+  h->base = base;
+  h->length = 0;
+  return p;
+}
+
+inline void AlignedFree(void* p)
+{
+  if (p == nullptr)
+    return;
+  TAllocHeader* h = (TAllocHeader*)p - 1;
+#if defined(__linux__)
+  if (h->length != 0)
+  {
+    munmap(h->base, h->length);
+    return;
+  }
+#endif
+  std::free(h->base);
+}
+
+// Массив из n элементов. Типы с тривиальным деструктором размещаются
+// выровненно, элементы создаются конструктором по умолчанию (для
+// тривиальных типов память не инициализируется), остальные - через new[]
+template<typename T>
+T* AllocArray(size_t n)
+{
+  if (std::is_trivially_destructible<T>::value)
+  {
+    if (n > ((size_t)-1 - 2 * ALLOC_ALIGNMENT) / sizeof(T))
+      throw std::bad_alloc();
+    T* p = (T*)AlignedAlloc(n * sizeof(T));
+    for (size_t i = 0; i < n; i++)
+      new (p + i) T;
+    return p;
+  }
+  return new T[n];
+}
+
+template<typename T>
+void FreeArray(T* p)
+{
+  if (std::is_trivially_destructible<T>::value)
+    AlignedFree(p);
+  else
+    delete[] p;
+}
+
+#endif
@@ -0,0 +1,129 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Подбор параметров ядер (ttune.h) замерами на текущей машине.
+// Кандидаты строятся по размерам кэшей, победители устанавливаются
+// как текущие параметры и могут быть сохранены в файл настройки,
+// который последующие запуски читают при старте:
+//
+//   if (!TuningLoaded())
+//     SaveTuning(TuningFileName(), Autotune());
+//
+//
+
+#ifndef __TAutotune_H__
+#define __TAutotune_H__
+
+#include <chrono>
+#include <cstddef>
+#include "tmatrix.h"
+#include "ttune.h"
+
+// наименьшее из reps измерений времени f(), с
+template<typename F>
+double TuneTime(F f, int reps)
+{
+  double best = 0;
+  for (int r = 0; r < reps; r++)
+  {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (r == 0 || t < best)
+      best = t;
+  }
+  return best;
+}
+
+// Параметры, найденные замерами на матрицах n x n (double):
+//  - блок умножения: сначала панель (depth, cols) в пределах L2 при
+//    текущем числе строк, затем число строк;
+//  - блок транспонирования: стороны 8..256;
+//  - порог редукции: наименьшее число листов, при котором параллельный
+//    подсчет быстрее последовательного.
+// Результат устанавливается текущим (SetTuning) и возвращается
+inline TTuning Autotune(size_t n = 384, int reps = 3)
+{
+  if (n == 0 || reps <= 0)
+    throw invalid_argument("Autotune size and repetitions should be positive");
+  const TCacheInfo cache = CacheSizes();
+  const size_t l2 = cache.l2 != 0 ? cache.l2 : 1 << 20;
+  TTuning best = Tuning();
+
+  TDynamicMatrix<double> a(n, GENERATE, [](size_t i, size_t j) { return double((i * 7 + j * 3) % 11) - 5; });
+  TDynamicMatrix<double> b(n, GENERATE, [](size_t i, size_t j) { return double((i * 5 + j) % 13) - 6; });
+  TDynamicMatrix<double> c(n, UNINITIALIZED);
+  auto multiply = [&]() { a.MultiplyInto<TPlusTimes<double>>(b, c); };
+  auto try_tuning = [&](const TTuning& t, double& best_time, auto run)
+  {
+    SetTuning(t);
+    const double time = TuneTime(run, reps);
+    if (best_time < 0 || time < best_time)
+    {
+      best_time = time;
+      best = t;
+    }
+  };
+
+  // встроенное ядро, даже если выбрана системная BLAS
+  const TBlasBackend backend = BlasBackend().load(std::memory_order_relaxed);
+  SetBlasBackend(BLAS_BUILTIN);
+  double best_time = -1;
+  // 0 - вся длина (без разбиения)
+  const size_t depths[] = { 0, 32, 64, 128, 256, 512 };
+  const size_t cols[] = { 0, 128, 256, 512, 1024, 2048, 4096 };
+  for (size_t d : depths)
+    for (size_t w : cols)
+    {
+      // панель не больше матрицы и, кроме варианта без разбиения, помещается в L2
+      if ((d != 0 && d >= n) || (w != 0 && w >= n))
+        continue;
+      const size_t panel = (d == 0 ? n : d) * (w == 0 ? n : w) * sizeof(double);
+      if (panel > l2 && (d != 0 || w != 0))
+        continue;
+      TTuning t = best;
+      t.multiply_depth = d;
+      t.multiply_cols = w;
+      try_tuning(t, best_time, multiply);
+    }
+  const TTuning panel = best;
+  best_time = -1;
+  for (size_t rows : { 1, 2, 4, 8, 16, 32 })
+  {
+    TTuning t = panel;
+    t.multiply_rows = rows;
+    try_tuning(t, best_time, multiply);
+  }
+  SetBlasBackend(backend);
+
+  best_time = -1;
+  TDynamicMatrix<double> tr(n, UNINITIALIZED);
+  for (size_t side : { 8, 16, 32, 64, 128, 256 })
+  {
+    TTuning t = best;
+    t.transpose_block = side;
+    try_tuning(t, best_time, [&]() { tr = a.transpose(); });
+  }
+
+  // порог: сумма вектора из nb листов параллельно и последовательно
+  TTuning serial = best;
+  serial.reduce_parallel_blocks = (size_t)-1;
+  size_t threshold = 0;
+  for (size_t nb = 2; nb <= 64 && threshold == 0; nb *= 2)
+  {
+    TDynamicVector<double> v(nb * REDUCE_BLOCK, FILL, 1.0);
+    volatile double sink = 0;
+    auto sum = [&]() { sink = sink + v.sum(); };
+    SetTuning(serial);
+    const double ts = TuneTime(sum, reps);
+    TTuning parallel = best;
+    parallel.reduce_parallel_blocks = nb;
+    SetTuning(parallel);
+    if (TuneTime(sum, reps) < ts)
+      threshold = nb;
+  }
+  best.reduce_parallel_blocks = threshold != 0 ? threshold : 128;
+  SetTuning(best);
+  return best;
+}
+
+#endif
@@ -0,0 +1,187 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Пакетные операции над множеством малых матриц одного размера
+//
+//
+
+#ifndef __TBatch_H__
+#define __TBatch_H__
+
+#include "tmatrix.h"
+
+// Число матриц, чередуемых поэлементно внутри одного блока пакета.
+// Внутренние циклы идут вдоль пакета и векторизуются по этому измерению
+const size_t BATCH_LANES = 16;
+// пакеты от этого числа элементов обрабатываются параллельно по блокам
+const size_t BATCH_PARALLEL_SIZE = MATRIX_PARALLEL_SIZE * MATRIX_PARALLEL_SIZE;
+
+// Пакет векторов длины n: элемент i вектора b хранится по адресу
+// ((b / BATCH_LANES) * n + i) * BATCH_LANES + b % BATCH_LANES
+template<typename T>
+class TVectorBatch
+{
+protected:
+  size_t n, cnt, blocks;
+  TDynamicVector<T> mem;
+public:
+  TVectorBatch(size_t len = 1, size_t count = 1) : n(len), cnt(count),
+    blocks((count + BATCH_LANES - 1) / BATCH_LANES), mem(len * blocks * BATCH_LANES)
+  {
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t count() const noexcept { return cnt; }
+  size_t block_count() const noexcept { return blocks; }
+
+  T& operator()(size_t b, size_t i)
+  {
+    return mem[((b / BATCH_LANES) * n + i) * BATCH_LANES + b % BATCH_LANES];
+  }
+  const T& operator()(size_t b, size_t i) const
+  {
+    return mem[((b / BATCH_LANES) * n + i) * BATCH_LANES + b % BATCH_LANES];
+  }
+  // начало блока из BATCH_LANES векторов
+  T* block(size_t blk) { return &mem[blk * n * BATCH_LANES]; }
+  const T* block(size_t blk) const { return &mem[blk * n * BATCH_LANES]; }
+
+  void set(size_t b, const TDynamicVector<T>& v)
+  {
+    if (b >= cnt || v.size() != n)
+      throw out_of_range("Vector does not fit the batch");
+    for (size_t i = 0; i < n; i++)
+      (*this)(b, i) = v[i];
+  }
+  TDynamicVector<T> get(size_t b) const
+  {
+    if (b >= cnt)
+      throw out_of_range("Batch index is out of range");
+    TDynamicVector<T> v(n);
+    for (size_t i = 0; i < n; i++)
+      v[i] = (*this)(b, i);
+    return v;
+  }
+};
+
+// Пакет матриц n x n: элемент (i, j) матрицы b хранится по адресу
+// ((b / BATCH_LANES) * n * n + i * n + j) * BATCH_LANES + b % BATCH_LANES
+template<typename T>
+class TMatrixBatch
+{
+protected:
+  size_t n, cnt, blocks;
+  TDynamicVector<T> mem;
+public:
+  TMatrixBatch(size_t s = 1, size_t count = 1) : n(s), cnt(count),
+    blocks((count + BATCH_LANES - 1) / BATCH_LANES), mem(s * s * blocks * BATCH_LANES)
+  {
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t count() const noexcept { return cnt; }
+  size_t block_count() const noexcept { return blocks; }
+
+  T& operator()(size_t b, size_t i, size_t j)
+  {
+    return mem[((b / BATCH_LANES) * n * n + i * n + j) * BATCH_LANES + b % BATCH_LANES];
+  }
+  const T& operator()(size_t b, size_t i, size_t j) const
+  {
+    return mem[((b / BATCH_LANES) * n * n + i * n + j) * BATCH_LANES + b % BATCH_LANES];
+  }
+  T* block(size_t blk) { return &mem[blk * n * n * BATCH_LANES]; }
+  const T* block(size_t blk) const { return &mem[blk * n * n * BATCH_LANES]; }
+
+  void set(size_t b, const TDynamicMatrix<T>& m)
+  {
+    if (b >= cnt || m.size() != n)
+      throw out_of_range("Matrix does not fit the batch");
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        (*this)(b, i, j) = m[i][j];
+  }
+  TDynamicMatrix<T> get(size_t b) const
+  {
+    if (b >= cnt)
+      throw out_of_range("Batch index is out of range");
+    TDynamicMatrix<T> m(n);
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        m[i][j] = (*this)(b, i, j);
+    return m;
+  }
+};
+
+// y[b] = a[b] * x[b] для всех b пакета; y не должен совпадать с x
+template<typename T>
+void BatchMultiply(const TMatrixBatch<T>& a, const TVectorBatch<T>& x, TVectorBatch<T>& y)
+{
+  const size_t n = a.size();
+  if (x.size() != n || x.count() != a.count())
+    throw length_error("Batch shapes should be equal");
+  if (&y == &x)
+    throw invalid_argument("Result batch should differ from operands");
+  if (y.size() != n || y.count() != a.count())
+    y = TVectorBatch<T>(n, a.count());
+
+  const int nb = (int)a.block_count();
+  #pragma omp parallel for schedule(static) if (a.count() * n * n >= BATCH_PARALLEL_SIZE)
+  for (int blk = 0; blk < nb; blk++)
+  {
+    const T* pa = a.block(blk);
+    const T* px = x.block(blk);
+    T* py = y.block(blk);
+    for (size_t i = 0; i < n; i++)
+    {
+      T acc[BATCH_LANES] = {};
+      for (size_t k = 0; k < n; k++)
+      {
+        const T* ak = pa + (i * n + k) * BATCH_LANES;
+        const T* xk = px + k * BATCH_LANES;
+        for (size_t l = 0; l < BATCH_LANES; l++)
+          acc[l] += ak[l] * xk[l];
+      }
+      for (size_t l = 0; l < BATCH_LANES; l++)
+        py[i * BATCH_LANES + l] = acc[l];
+    }
+  }
+}
+
+// c[b] = a[b] * b[b] для всех b пакета; c не должен совпадать с операндами
+template<typename T>
+void BatchMultiply(const TMatrixBatch<T>& a, const TMatrixBatch<T>& b, TMatrixBatch<T>& c)
+{
+  const size_t n = a.size();
+  if (b.size() != n || b.count() != a.count())
+    throw length_error("Batch shapes should be equal");
+  if (&c == &a || &c == &b)
+    throw invalid_argument("Result batch should differ from operands");
+  if (c.size() != n || c.count() != a.count())
+    c = TMatrixBatch<T>(n, a.count());
+
+  const int nb = (int)a.block_count();
+  #pragma omp parallel for schedule(static) if (a.count() * n * n >= BATCH_PARALLEL_SIZE)
+  for (int blk = 0; blk < nb; blk++)
+  {
+    const T* pa = a.block(blk);
+    const T* pb = b.block(blk);
+    T* pc = c.block(blk);
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+      {
+        T acc[BATCH_LANES] = {};
+        for (size_t k = 0; k < n; k++)
+        {
+          const T* aik = pa + (i * n + k) * BATCH_LANES;
+          const T* bkj = pb + (k * n + j) * BATCH_LANES;
+          for (size_t l = 0; l < BATCH_LANES; l++)
+            acc[l] += aik[l] * bkj[l];
+        }
+        T* cij = pc + (i * n + j) * BATCH_LANES;
+        for (size_t l = 0; l < BATCH_LANES; l++)
+          cij[l] = acc[l];
+      }
+  }
+}
+
+#endif
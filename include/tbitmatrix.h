@@ -0,0 +1,226 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Упакованная булева матрица: 64 элемента в машинном слове.
+// Произведение над GF(2) и булево (OR-AND) произведение методом
+// четырех русских, транзитивное замыкание
+//
+//
+
+#ifndef __TBitMatrix_H__
+#define __TBitMatrix_H__
+
+#include <cstdint>
+#include "tmatrix.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline int BitCount(uint64_t x)
+{
+#if defined(_MSC_VER)
+  return (int)__popcnt64(x);
+#else
+  return __builtin_popcountll(x);
+#endif
+}
+
+// Ширина блока метода четырех русских: таблица из 2^8 комбинаций строк
+const size_t BIT_M4RM_BITS = 8;
+
+class TBitMatrix
+{
+protected:
+  size_t n, words;
+  TDynamicVector<uint64_t> mem;
+
+  // C = A (*) B, где сумма - op (XOR для GF(2), OR для булевой алгебры)
+  template<typename Op>
+  static TBitMatrix Multiply(const TBitMatrix& a, const TBitMatrix& b, Op op)
+  {
+    if (a.n != b.n)
+      throw length_error("Matrix sizes should be equal");
+    const size_t n = a.n, w = a.words;
+    const size_t tsize = size_t(1) << BIT_M4RM_BITS;
+    TBitMatrix c(n);
+    TDynamicVector<uint64_t> table(tsize * w);
+    for (size_t k0 = 0; k0 < n; k0 += BIT_M4RM_BITS)
+    {
+      const size_t bits = std::min(BIT_M4RM_BITS, n - k0);
+      // таблица всех комбинаций строк k0..k0+bits-1 матрицы B
+      for (size_t t = 0; t < w; t++)
+        table[t] = 0;
+      for (size_t j = 1; j < (size_t(1) << bits); j++)
+      {
+        size_t low = 0;
+        while (!((j >> low) & 1))
+          low++;
+        const uint64_t* prev = &table[(j & (j - 1)) * w];
+        const uint64_t* row = b.row(k0 + low);
+        uint64_t* dst = &table[j * w];
+        for (size_t t = 0; t < w; t++)
+          dst[t] = op(prev[t], row[t]);
+      }
+      const size_t word = k0 / 64, shift = k0 % 64;
+      const uint64_t mask = (uint64_t(1) << bits) - 1;
+      const int nn = (int)n;
+      #pragma omp parallel for if (n >= 512)
+      for (int i = 0; i < nn; i++)
+      {
+        const size_t idx = (size_t)((a.row(i)[word] >> shift) & mask);
+        if (idx == 0)
+          continue;
+        const uint64_t* src = &table[idx * w];
+        uint64_t* dst = c.row(i);
+        for (size_t t = 0; t < w; t++)
+          dst[t] = op(dst[t], src[t]);
+      }
+    }
+    return c;
+  }
+
+public:
+  TBitMatrix(size_t s = 1) : n(s), words((s + 63) / 64), mem(words * s)
+  {
+    if (n > MAX_MATRIX_SIZE * 64)
+      throw out_of_range("Matrix size is too large");
+  }
+  // ненулевые элементы m становятся единицами
+  template<typename T>
+  explicit TBitMatrix(const TDynamicMatrix<T>& m) : TBitMatrix(m.size())
+  {
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        if (m[i][j] != T())
+          set(i, j, true);
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t row_words() const noexcept { return words; }
+
+  uint64_t* row(size_t i) { return &mem[i * words]; }
+  const uint64_t* row(size_t i) const { return &mem[i * words]; }
+
+  bool get(size_t i, size_t j) const
+  {
+    return (row(i)[j / 64] >> (j % 64)) & 1;
+  }
+  void set(size_t i, size_t j, bool val)
+  {
+    uint64_t bit = uint64_t(1) << (j % 64);
+    if (val)
+      row(i)[j / 64] |= bit;
+    else
+      row(i)[j / 64] &= ~bit;
+  }
+  bool at(size_t i, size_t j) const
+  {
+    if (i >= n || j >= n)
+      throw out_of_range("Matrix index is out of range");
+    return get(i, j);
+  }
+
+  bool operator==(const TBitMatrix& m) const noexcept
+  {
+    return n == m.n && mem == m.mem;
+  }
+  bool operator!=(const TBitMatrix& m) const noexcept
+  {
+    return !(*this == m);
+  }
+
+  // число единиц
+  size_t count() const
+  {
+    size_t res = 0;
+    for (size_t i = 0; i < mem.size(); i++)
+      res += BitCount(mem[i]);
+    return res;
+  }
+
+  template<typename T>
+  TDynamicMatrix<T> ToMatrix() const
+  {
+    TDynamicMatrix<T> m(n);
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        m[i][j] = get(i, j) ? T(1) : T();
+    return m;
+  }
+
+  // произведение над GF(2)
+  friend TBitMatrix MultiplyGF2(const TBitMatrix& a, const TBitMatrix& b)
+  {
+    return Multiply(a, b, [](uint64_t x, uint64_t y) { return x ^ y; });
+  }
+  // булево произведение: c[i][j] = OR_k (a[i][k] AND b[k][j])
+  friend TBitMatrix MultiplyBoolean(const TBitMatrix& a, const TBitMatrix& b)
+  {
+    return Multiply(a, b, [](uint64_t x, uint64_t y) { return x | y; });
+  }
+
+  // y = A x над GF(2), вектор упакован так же, как строка
+  friend TDynamicVector<uint64_t> MultiplyGF2(const TBitMatrix& a, const TDynamicVector<uint64_t>& x)
+  {
+    if (x.size() != a.words)
+      throw length_error("Vector size should match matrix row words");
+    TDynamicVector<uint64_t> y(a.words);
+    for (size_t i = 0; i < a.n; i++)
+    {
+      const uint64_t* r = a.row(i);
+      int cnt = 0;
+      for (size_t t = 0; t < a.words; t++)
+        cnt += BitCount(r[t] & x[t]);
+      if (cnt & 1)
+        y[i / 64] |= uint64_t(1) << (i % 64);
+    }
+    return y;
+  }
+
+  // транзитивное замыкание (алгоритм Уоршелла по словам)
+  friend TBitMatrix TransitiveClosure(const TBitMatrix& a)
+  {
+    TBitMatrix c(a);
+    const size_t w = c.words;
+    const int nn = (int)c.n;
+    for (size_t k = 0; k < c.n; k++)
+    {
+      const uint64_t* rk = c.row(k);
+      #pragma omp parallel for if (c.n >= 512)
+      for (int i = 0; i < nn; i++)
+      {
+        if ((size_t)i == k || !c.get(i, k))
+          continue;
+        uint64_t* ri = c.row(i);
+        for (size_t t = 0; t < w; t++)
+          ri[t] |= rk[t];
+      }
+    }
+    return c;
+  }
+
+  // ввод/вывод в виде строк из 0 и 1
+  friend istream& operator>>(istream& istr, TBitMatrix& m)
+  {
+    for (size_t i = 0; i < m.n; i++)
+      for (size_t j = 0; j < m.n; j++)
+      {
+        int x;
+        istr >> x;
+        m.set(i, j, x != 0);
+      }
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TBitMatrix& m)
+  {
+    for (size_t i = 0; i < m.n; i++)
+    {
+      for (size_t j = 0; j < m.n; j++)
+        ostr << (m.get(i, j) ? '1' : '0') << ' ';
+      ostr << endl;
+    }
+    return ostr;
+  }
+};
+
+#endif
@@ -0,0 +1,237 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Выбор реализации базовых операций линейной алгебры (GEMM, GEMV, AXPY,
+// DOT, TRSM): встроенные циклы или системная библиотека CBLAS (OpenBLAS,
+// MKL и т.п.). Системная библиотека подключается при сборке с макросом
+// TMATRIX_USE_CBLAS (нужны заголовок cblas.h и библиотека, например
+// -lopenblas)
+//
+//
+
+#ifndef __TBlas_H__
+#define __TBlas_H__
+
+#include <atomic>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include "talloc.h"
+
+#ifdef TMATRIX_USE_CBLAS
+#include <cblas.h>
+#endif
+
+// Реализация операций над float и double:
+//  BLAS_BUILTIN - циклы библиотеки (детерминированные редукции);
+//  BLAS_SYSTEM - системная CBLAS, если она подключена при сборке, иначе
+//    встроенная реализация. Порядок суммирования определяется
+//    библиотекой, результаты могут отличаться в последних разрядах
+enum TBlasBackend { BLAS_BUILTIN, BLAS_SYSTEM };
+
+inline bool SystemBlasAvailable()
+{
+#ifdef TMATRIX_USE_CBLAS
+  return true;
+#else
+  return false;
+#endif
+}
+
+// выбор читается ядрами, в том числе из других потоков
+inline std::atomic<TBlasBackend>& BlasBackend()
+{
+  static std::atomic<TBlasBackend> backend(SystemBlasAvailable() ? BLAS_SYSTEM : BLAS_BUILTIN);
+  return backend;
+}
+
+inline void SetBlasBackend(TBlasBackend backend)
+{
+  BlasBackend().store(backend, std::memory_order_relaxed);
+}
+
+// выполняются ли операции над T системной библиотекой
+template<typename T>
+bool UseSystemBlas()
+{
+  return SystemBlasAvailable() && BlasBackend().load(std::memory_order_relaxed) == BLAS_SYSTEM &&
+    (std::is_same<T, float>::value || std::is_same<T, double>::value);
+}
+
+// Вызовы CBLAS для матриц по строкам (row-major). Шаблонные варианты -
+// заглушки для остальных типов, они не вызываются (см. UseSystemBlas)
+template<typename T> void CblasGemm(int, const T*, int, const T*, int, T*, int) {}
+template<typename T> void CblasGemv(int, const T*, int, const T*, T*) {}
+template<typename T> T CblasDot(int, const T*, const T*) { return T(); }
+template<typename T> void CblasAxpy(int, T, const T*, T*) {}
+template<typename T> void CblasTrsm(int, int, bool, const T*, int, T*, int) {}
+
+#ifdef TMATRIX_USE_CBLAS
+inline void CblasGemm(int n, const double* a, int lda, const double* b, int ldb, double* c, int ldc)
+{
+  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, n, n, 1.0, a, lda, b, ldb, 0.0, c, ldc);
+}
+inline void CblasGemm(int n, const float* a, int lda, const float* b, int ldb, float* c, int ldc)
+{
+  cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, n, n, n, 1.0f, a, lda, b, ldb, 0.0f, c, ldc);
+}
+inline void CblasGemv(int n, const double* a, int lda, const double* x, double* y)
+{
+  cblas_dgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0, a, lda, x, 1, 0.0, y, 1);
+}
+inline void CblasGemv(int n, const float* a, int lda, const float* x, float* y)
+{
+  cblas_sgemv(CblasRowMajor, CblasNoTrans, n, n, 1.0f, a, lda, x, 1, 0.0f, y, 1);
+}
+inline double CblasDot(int n, const double* x, const double* y)
+{
+  return cblas_ddot(n, x, 1, y, 1);
+}
+inline float CblasDot(int n, const float* x, const float* y)
+{
+  return cblas_sdot(n, x, 1, y, 1);
+}
+inline void CblasAxpy(int n, double a, const double* x, double* y)
+{
+  cblas_daxpy(n, a, x, 1, y, 1);
+}
+inline void CblasAxpy(int n, float a, const float* x, float* y)
+{
+  cblas_saxpy(n, a, x, 1, y, 1);
+}
+// A X = B, A - n x n треугольная, B - n x m
+inline void CblasTrsm(int n, int m, bool upper, const double* a, int lda, double* b, int ldb)
+{
+  cblas_dtrsm(CblasRowMajor, CblasLeft, upper ? CblasUpper : CblasLower, CblasNoTrans, CblasNonUnit, n, m, 1.0, a, lda, b, ldb);
+}
+inline void CblasTrsm(int n, int m, bool upper, const float* a, int lda, float* b, int ldb)
+{
+  cblas_strsm(CblasRowMajor, CblasLeft, upper ? CblasUpper : CblasLower, CblasNoTrans, CblasNonUnit, n, m, 1.0f, a, lda, b, ldb);
+}
+#endif
+
+// Шаг строк row(0..n), если они лежат в памяти с постоянным шагом
+// не меньше cols (как у матрицы-представления), иначе 0
+template<typename Row>
+size_t RowStride(size_t n, size_t cols, Row row)
+{
+  if (n == 1)
+    return cols;
+  const ptrdiff_t ld = row(1) - row(0);
+  if (ld < (ptrdiff_t)cols)
+    return 0;
+  for (size_t i = 2; i < n; i++)
+    if (row(i) != row(0) + i * ld)
+      return 0;
+  return (size_t)ld;
+}
+
+// Матрица n x cols, заданная строками row(i), в виде (указатель, шаг) для
+// CBLAS. Строки с постоянным шагом передаются как есть, иначе копируются
+// в непрерывный буфер: O(n cols) против O(n^2 cols) у GEMM и TRSM
+template<typename T>
+class TBlasPanel
+{
+  T* own;
+
+  TBlasPanel(const TBlasPanel&) = delete;
+  TBlasPanel& operator=(const TBlasPanel&) = delete;
+public:
+  T* p;
+  size_t ld;
+
+  // load - скопировать строки в буфер (для входных данных)
+  template<typename Row>
+  TBlasPanel(size_t n, size_t cols, Row row, bool load) : own(nullptr)
+  {
+    ld = RowStride(n, cols, row);
+    if (ld != 0)
+    {
+      // входные строки через p не изменяются
+      p = const_cast<T*>(row(0));
+      return;
+    }
+    ld = cols;
+    p = own = AllocArray<T>(n * cols);
+    if (load)
+      for (size_t i = 0; i < n; i++)
+        std::copy(row(i), row(i) + cols, own + i * cols);
+  }
+  ~TBlasPanel()
+  {
+    if (own != nullptr)
+      FreeArray(own);
+  }
+
+  // вернуть результат из буфера в строки
+  template<typename Row>
+  void store(size_t n, size_t cols, Row row) const
+  {
+    if (own != nullptr)
+      for (size_t i = 0; i < n; i++)
+        std::copy(own + i * cols, own + (i + 1) * cols, row(i));
+  }
+};
+
+// Операции через системную библиотеку. Возвращают false, если операцию
+// должна выполнить встроенная реализация. Матрицы задаются функциями
+// строк row(i), возвращающими указатель на начало строки i
+
+// C = A B, все матрицы n x n
+template<typename T, typename RowA, typename RowB, typename RowC>
+bool SystemGemm(size_t n, RowA a, RowB b, RowC c)
+{
+  if (!UseSystemBlas<T>())
+    return false;
+  TBlasPanel<T> pa(n, n, a, true), pb(n, n, b, true), pc(n, n, c, false);
+  CblasGemm((int)n, pa.p, (int)pa.ld, pb.p, (int)pb.ld, pc.p, (int)pc.ld);
+  pc.store(n, n, c);
+  return true;
+}
+
+// y = A x; строки с разным шагом - по одному скалярному произведению
+template<typename T, typename RowA>
+bool SystemGemv(size_t n, RowA a, const T* x, T* y)
+{
+  if (!UseSystemBlas<T>())
+    return false;
+  const size_t ld = RowStride(n, n, a);
+  if (ld != 0)
+    CblasGemv((int)n, a(0), (int)ld, x, y);
+  else
+    for (size_t i = 0; i < n; i++)
+      y[i] = CblasDot((int)n, a(i), x);
+  return true;
+}
+
+template<typename T>
+bool SystemDot(size_t n, const T* x, const T* y, T& res)
+{
+  if (!UseSystemBlas<T>())
+    return false;
+  res = CblasDot((int)n, x, y);
+  return true;
+}
+
+// y += a x
+template<typename T>
+bool SystemAxpy(size_t n, const T& a, const T* x, T* y)
+{
+  if (!UseSystemBlas<T>())
+    return false;
+  CblasAxpy((int)n, a, x, y);
+  return true;
+}
+
+// A X = B с треугольной A (n x n), B (n x m) заменяется на X
+template<typename T, typename RowA, typename RowB>
+bool SystemTrsm(size_t n, size_t m, bool upper, RowA a, RowB b)
+{
+  if (!UseSystemBlas<T>())
+    return false;
+  TBlasPanel<T> pa(n, n, a, true), pb(n, m, b, true);
+  CblasTrsm((int)n, (int)m, upper, pa.p, (int)pa.ld, pb.p, (int)pb.ld);
+  pb.store(n, m, b);
+  return true;
+}
+
+#endif
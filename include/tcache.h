@@ -0,0 +1,156 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Кэш результатов матричных произведений
+//
+//
+
+#ifndef __TCache_H__
+#define __TCache_H__
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "thash.h"
+
+// Кэш произведений A * B с вытеснением давно не использованных записей
+// (LRU) при превышении заданного объема памяти. Ключ - пара хешей
+// операндов: хеш содержимого (Hash, TMatrixHasher) или любой другой
+// 128-битный идентификатор версии матрицы, выбранный пользователем.
+// Методы потокобезопасны; произведение, копирование результатов и
+// освобождение вытесненных записей выполняются вне блокировки
+template<typename T>
+class TProductCache
+{
+protected:
+  typedef pair<THash128, THash128> Key;
+  struct Entry
+  {
+    Key key;
+    shared_ptr<const TDynamicMatrix<T>> value;
+    size_t bytes;
+  };
+  typedef typename list<Entry>::iterator Iter;
+
+  size_t capacity, used;
+  size_t nhits, nmisses, nevictions;
+  list<Entry> lru; // в начале - последние использованные
+  map<Key, Iter> index;
+  mutable mutex mtx;
+
+  static size_t EntryBytes(const TDynamicMatrix<T>& m)
+  {
+    return m.size() * m.size() * sizeof(T) + m.size() * sizeof(TDynamicVector<T>) + sizeof(Entry);
+  }
+
+  // вытесненные записи переносятся в evicted и освобождаются вызывающим
+  // после снятия блокировки
+  void Evict(list<Entry>& evicted)
+  {
+    while (used > capacity && !lru.empty())
+    {
+      used -= lru.back().bytes;
+      index.erase(lru.back().key);
+      evicted.splice(evicted.begin(), lru, std::prev(lru.end()));
+      nevictions++;
+    }
+  }
+
+  // запись по ключу (пустой указатель, если ее нет); найденная запись
+  // становится самой новой
+  shared_ptr<const TDynamicMatrix<T>> Find(const Key& key)
+  {
+    lock_guard<mutex> lock(mtx);
+    typename map<Key, Iter>::iterator it = index.find(key);
+    if (it == index.end())
+    {
+      nmisses++;
+      return nullptr;
+    }
+    nhits++;
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->value;
+  }
+
+  void Store(const Key& key, shared_ptr<const TDynamicMatrix<T>> value, size_t bytes)
+  {
+    Entry e = { key, std::move(value), bytes };
+    list<Entry> evicted;
+    lock_guard<mutex> lock(mtx);
+    typename map<Key, Iter>::iterator it = index.find(key);
+    if (it != index.end())
+    {
+      used -= it->second->bytes;
+      evicted.splice(evicted.begin(), lru, it->second);
+      index.erase(it);
+    }
+    lru.push_front(std::move(e));
+    index[key] = lru.begin();
+    used += bytes;
+    Evict(evicted);
+  }
+
+public:
+  explicit TProductCache(size_t max_bytes) : capacity(max_bytes), used(0), nhits(0), nmisses(0), nevictions(0)
+  {
+  }
+
+  // поиск готового результата; при успехе запись становится самой новой
+  bool lookup(const THash128& ha, const THash128& hb, TDynamicMatrix<T>& res)
+  {
+    shared_ptr<const TDynamicMatrix<T>> found = Find(Key(ha, hb));
+    if (!found)
+      return false;
+    res = *found;
+    return true;
+  }
+
+  void insert(const THash128& ha, const THash128& hb, TDynamicMatrix<T> value)
+  {
+    const size_t bytes = EntryBytes(value);
+    if (bytes <= capacity)
+      Store(Key(ha, hb), make_shared<const TDynamicMatrix<T>>(std::move(value)), bytes);
+  }
+
+  // произведение с известными ключами операндов; при промахе результат
+  // переносится в запись, копируется только возвращаемое значение
+  TDynamicMatrix<T> multiply(const TDynamicMatrix<T>& a, const THash128& ha,
+    const TDynamicMatrix<T>& b, const THash128& hb)
+  {
+    const Key key(ha, hb);
+    shared_ptr<const TDynamicMatrix<T>> found = Find(key);
+    if (found)
+      return *found;
+    TDynamicMatrix<T> res = a.template Multiply<TPlusTimes<T>>(b);
+    const size_t bytes = EntryBytes(res);
+    if (bytes > capacity)
+      return res;
+    found = make_shared<const TDynamicMatrix<T>>(std::move(res));
+    Store(key, found, bytes);
+    return *found;
+  }
+  // произведение с ключами по содержимому операндов
+  TDynamicMatrix<T> multiply(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+  {
+    return multiply(a, Hash(a), b, Hash(b));
+  }
+
+  void clear()
+  {
+    list<Entry> evicted;
+    lock_guard<mutex> lock(mtx);
+    evicted.swap(lru);
+    index.clear();
+    used = 0;
+  }
+
+  size_t hits() const { lock_guard<mutex> lock(mtx); return nhits; }
+  size_t misses() const { lock_guard<mutex> lock(mtx); return nmisses; }
+  size_t evictions() const { lock_guard<mutex> lock(mtx); return nevictions; }
+  size_t entries() const { lock_guard<mutex> lock(mtx); return lru.size(); }
+  size_t bytes() const { lock_guard<mutex> lock(mtx); return used; }
+  size_t max_bytes() const noexcept { return capacity; }
+};
+
+#endif
@@ -0,0 +1,365 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Собственные значения и векторы симметричных матриц
+//
+//
+
+#ifndef __TEigen_H__
+#define __TEigen_H__
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "tmatrix.h"
+
+// До этого размера используется параллельный циклический метод Якоби,
+// для больших матриц - трехдиагонализация Хаусхолдера и неявный QL
+const size_t EIGEN_JACOBI_MAX_SIZE = 64;
+// Тур вращений стоит O(n^2) операций и выполняется параллельно начиная
+// с этого размера: при n <= EIGEN_JACOBI_MAX_SIZE запуск потоков на каждом
+// туре дороже самого тура, поэтому при выборе метода в SymmetricEigen вращения
+// выполняются последовательно (параллельно - только при прямом вызове
+// EigenJacobi для больших матриц)
+const size_t EIGEN_JACOBI_PARALLEL_SIZE = 256;
+const int EIGEN_MAX_SWEEPS = 60;
+
+// Упорядочивание собственных пар по возрастанию собственных значений.
+// Собственный вектор i хранится в строке i (непрерывный участок памяти)
+template<typename T>
+void SortEigenPairs(TDynamicVector<T>& values, TDynamicMatrix<T>& vectors)
+{
+  size_t n = values.size();
+  for (size_t i = 0; i + 1 < n; i++)
+  {
+    size_t k = i;
+    for (size_t j = i + 1; j < n; j++)
+      if (values[j] < values[k])
+        k = j;
+    if (k != i)
+    {
+      std::swap(values[i], values[k]);
+      swap(vectors[i], vectors[k]);
+    }
+  }
+}
+
+// Параллельный циклический метод Якоби.
+// Вращения одного тура (круговой турнир) затрагивают непересекающиеся пары
+// индексов, поэтому применяются одновременно
+template<typename T>
+void EigenJacobi(const TDynamicMatrix<T>& m, TDynamicVector<T>& values, TDynamicMatrix<T>& vectors)
+{
+  static_assert(std::is_floating_point<T>::value, "EigenJacobi requires floating point T");
+  const size_t n = m.size();
+  TDynamicMatrix<T> a(m);
+  TDynamicMatrix<T> v(n);
+  for (size_t i = 0; i < n; i++)
+    v[i][i] = T(1);
+
+  const size_t players = n + n % 2;
+  const size_t pairs = players / 2;
+  TDynamicVector<size_t> P(pairs), Q(pairs);
+  TDynamicVector<T> C(pairs), S(pairs);
+
+  T norm = T();
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      norm += a[i][j] * a[i][j];
+  const T eps = std::numeric_limits<T>::epsilon();
+  const T tol = eps * eps * norm * T(n);
+
+  int sweep = 0;
+  for (; sweep < EIGEN_MAX_SWEEPS; sweep++)
+  {
+    T off = T();
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = i + 1; j < n; j++)
+        off += a[i][j] * a[i][j];
+    if (off <= tol)
+      break;
+
+    for (size_t r = 0; r + 1 < players; r++)
+    {
+      // пары тура r: (r, players-1) и (r+k, r-k) по модулю players-1
+      size_t cnt = 0;
+      for (size_t k = 0; k < pairs; k++)
+      {
+        size_t p, q;
+        if (k == 0)
+        {
+          p = r;
+          q = players - 1;
+        }
+        else
+        {
+          p = (r + k) % (players - 1);
+          q = (r + players - 1 - k) % (players - 1);
+        }
+        if (p > q)
+          std::swap(p, q);
+        if (q >= n || a[p][q] == T())
+          continue;
+        T theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+        T t = T(1) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+        if (theta < 0)
+          t = -t;
+        C[cnt] = T(1) / std::sqrt(t * t + 1);
+        S[cnt] = t * C[cnt];
+        P[cnt] = p;
+        Q[cnt] = q;
+        cnt++;
+      }
+      const int ncnt = (int)cnt;
+      const int nn = (int)n;
+
+      // A = J^T A, V = J^T V: вращения строк
+      #pragma omp parallel for if (n >= EIGEN_JACOBI_PARALLEL_SIZE)
+      for (int k = 0; k < ncnt; k++)
+      {
+        const T c = C[k], s = S[k];
+        T* ap = &a[P[k]][0];
+        T* aq = &a[Q[k]][0];
+        T* vp = &v[P[k]][0];
+        T* vq = &v[Q[k]][0];
+        for (size_t j = 0; j < n; j++)
+        {
+          T x = ap[j], y = aq[j];
+          ap[j] = c * x - s * y;
+          aq[j] = s * x + c * y;
+          x = vp[j];
+          y = vq[j];
+          vp[j] = c * x - s * y;
+          vq[j] = s * x + c * y;
+        }
+      }
+      // A = A J: вращения столбцов, распределенные по строкам
+      #pragma omp parallel for if (n >= EIGEN_JACOBI_PARALLEL_SIZE)
+      for (int i = 0; i < nn; i++)
+      {
+        T* ai = &a[i][0];
+        for (size_t k = 0; k < cnt; k++)
+        {
+          const T c = C[k], s = S[k];
+          T x = ai[P[k]], y = ai[Q[k]];
+          ai[P[k]] = c * x - s * y;
+          ai[Q[k]] = s * x + c * y;
+        }
+      }
+    }
+  }
+  if (sweep == EIGEN_MAX_SWEEPS)
+    throw runtime_error("Jacobi eigenvalue iteration did not converge");
+
+  values = TDynamicVector<T>(n);
+  for (size_t i = 0; i < n; i++)
+    values[i] = a[i][i];
+  vectors = v;
+  SortEigenPairs(values, vectors);
+}
+
+// Трехдиагонализация Хаусхолдера с последующим неявным QL со сдвигами.
+// Используется нижний треугольник m
+template<typename T>
+void EigenTridiagonalQR(const TDynamicMatrix<T>& m, TDynamicVector<T>& values, TDynamicMatrix<T>& vectors)
+{
+  static_assert(std::is_floating_point<T>::value, "EigenTridiagonalQR requires floating point T");
+  const size_t n = m.size();
+  TDynamicMatrix<T> V(m);
+  TDynamicVector<T> d(n), e(n);
+
+  // редукция к трехдиагональному виду, V накапливает преобразования
+  for (size_t j = 0; j < n; j++)
+    d[j] = V[n - 1][j];
+  for (size_t i = n - 1; i > 0; i--)
+  {
+    T scale = T(), h = T();
+    for (size_t k = 0; k < i; k++)
+      scale += std::abs(d[k]);
+    if (scale == T())
+    {
+      e[i] = d[i - 1];
+      for (size_t j = 0; j < i; j++)
+      {
+        d[j] = V[i - 1][j];
+        V[i][j] = T();
+        V[j][i] = T();
+      }
+    }
+    else
+    {
+      for (size_t k = 0; k < i; k++)
+      {
+        d[k] /= scale;
+        h += d[k] * d[k];
+      }
+      T f = d[i - 1];
+      T g = std::sqrt(h);
+      if (f > 0)
+        g = -g;
+      e[i] = scale * g;
+      h -= f * g;
+      d[i - 1] = f - g;
+      for (size_t j = 0; j < i; j++)
+        e[j] = T();
+      for (size_t j = 0; j < i; j++)
+      {
+        f = d[j];
+        V[j][i] = f;
+        g = e[j] + V[j][j] * f;
+        for (size_t k = j + 1; k < i; k++)
+        {
+          g += V[k][j] * d[k];
+          e[k] += V[k][j] * f;
+        }
+        e[j] = g;
+      }
+      f = T();
+      for (size_t j = 0; j < i; j++)
+      {
+        e[j] /= h;
+        f += e[j] * d[j];
+      }
+      T hh = f / (h + h);
+      for (size_t j = 0; j < i; j++)
+        e[j] -= hh * d[j];
+      // ранг-2 обновление: строки k независимы
+      const int ni = (int)i;
+      #pragma omp parallel for if (i > 256)
+      for (int k = 0; k < ni; k++)
+      {
+        T* vk = &V[k][0];
+        const T ek = e[k], dk = d[k];
+        for (int j = 0; j <= k; j++)
+          vk[j] -= d[j] * ek + e[j] * dk;
+      }
+      for (size_t j = 0; j < i; j++)
+      {
+        d[j] = V[i - 1][j];
+        V[i][j] = T();
+      }
+    }
+    d[i] = h;
+  }
+
+  // накопление ортогонального преобразования
+  for (size_t i = 0; i + 1 < n; i++)
+  {
+    V[n - 1][i] = V[i][i];
+    V[i][i] = T(1);
+    T h = d[i + 1];
+    if (h != T())
+    {
+      for (size_t k = 0; k <= i; k++)
+        d[k] = V[k][i + 1] / h;
+      const int ni = (int)i;
+      #pragma omp parallel for if (i > 256)
+      for (int j = 0; j <= ni; j++)
+      {
+        T g = T();
+        for (size_t k = 0; k <= i; k++)
+          g += V[k][i + 1] * V[k][j];
+        for (size_t k = 0; k <= i; k++)
+          V[k][j] -= g * d[k];
+      }
+    }
+    for (size_t k = 0; k <= i; k++)
+      V[k][i + 1] = T();
+  }
+  for (size_t j = 0; j < n; j++)
+  {
+    d[j] = V[n - 1][j];
+    V[n - 1][j] = T();
+  }
+  V[n - 1][n - 1] = T(1);
+  e[0] = T();
+
+  // собственные векторы вращаются по строкам Z = V^T
+  TDynamicMatrix<T> Z(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      Z[j][i] = V[i][j];
+
+  // неявный QL со сдвигами Уилкинсона
+  for (size_t i = 1; i < n; i++)
+    e[i - 1] = e[i];
+  e[n - 1] = T();
+  T f = T(), tst1 = T();
+  const T eps = std::numeric_limits<T>::epsilon();
+  for (size_t l = 0; l < n; l++)
+  {
+    tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+    size_t mm = l;
+    while (mm < n - 1 && std::abs(e[mm]) > eps * tst1)
+      mm++;
+    if (mm > l)
+    {
+      int iter = 0;
+      do
+      {
+        if (++iter > 30 * EIGEN_MAX_SWEEPS)
+          throw runtime_error("QL eigenvalue iteration did not converge");
+        T g = d[l];
+        T p = (d[l + 1] - g) / (2 * e[l]);
+        T r = std::hypot(p, T(1));
+        if (p < 0)
+          r = -r;
+        d[l] = e[l] / (p + r);
+        d[l + 1] = e[l] * (p + r);
+        T dl1 = d[l + 1];
+        T h = g - d[l];
+        for (size_t i = l + 2; i < n; i++)
+          d[i] -= h;
+        f += h;
+
+        p = d[mm];
+        T c = T(1), c2 = c, c3 = c;
+        T el1 = e[l + 1];
+        T s = T(), s2 = T();
+        for (size_t i = mm; i-- > l;)
+        {
+          c3 = c2;
+          c2 = c;
+          s2 = s;
+          g = c * e[i];
+          h = c * p;
+          r = std::hypot(p, e[i]);
+          e[i + 1] = s * r;
+          s = e[i] / r;
+          c = p / r;
+          p = c * d[i] - s * g;
+          d[i + 1] = h + s * (c * g + s * d[i]);
+          T* zi = &Z[i][0];
+          T* zi1 = &Z[i + 1][0];
+          for (size_t k = 0; k < n; k++)
+          {
+            T x = zi1[k];
+            zi1[k] = s * zi[k] + c * x;
+            zi[k] = c * zi[k] - s * x;
+          }
+        }
+        p = -s * s2 * c3 * el1 * e[l] / dl1;
+        e[l] = s * p;
+        d[l] = c * p;
+      } while (std::abs(e[l]) > eps * tst1);
+    }
+    d[l] += f;
+    e[l] = T();
+  }
+
+  values = d;
+  vectors = Z;
+  SortEigenPairs(values, vectors);
+}
+
+// Все собственные значения (по возрастанию) и собственные векторы
+// (строки vectors) симметричной матрицы
+template<typename T>
+void SymmetricEigen(const TDynamicMatrix<T>& m, TDynamicVector<T>& values, TDynamicMatrix<T>& vectors)
+{
+  if (m.size() <= EIGEN_JACOBI_MAX_SIZE)
+    EigenJacobi(m, values, vectors);
+  else
+    EigenTridiagonalQR(m, values, vectors);
+}
+
+#endif
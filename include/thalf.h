@@ -0,0 +1,162 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// 16-битные вещественные типы элементов: IEEE half и bfloat16.
+// Хранение в 2 байтах, арифметика и накопление сумм во float
+//
+//
+
+#ifndef __THalf_H__
+#define __THalf_H__
+
+#include <cstdint>
+#include <cstring>
+#include "tmatrix.h"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+inline uint32_t FloatBits(float f)
+{
+  uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+  return x;
+}
+
+inline float BitsFloat(uint32_t x)
+{
+  float f;
+  std::memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+// float -> IEEE half с округлением к ближайшему четному
+inline uint16_t FloatToHalfBits(float f)
+{
+#if defined(__F16C__)
+  return (uint16_t)_cvtss_sh(f, 0);
+#else
+  uint32_t x = FloatBits(f);
+  uint32_t sign = (x >> 16) & 0x8000;
+  uint32_t mant = x & 0x7fffff;
+  int exp = (int)((x >> 23) & 0xff);
+  if (exp == 0xff)
+    return (uint16_t)(sign | 0x7c00 | (mant ? 0x200 | (mant >> 13) : 0));
+  int e = exp - 127 + 15;
+  if (e >= 0x1f)
+    return (uint16_t)(sign | 0x7c00);
+  if (e <= 0)
+  {
+    // денормализованный результат
+    if (e < -10)
+      return (uint16_t)sign;
+    mant |= 0x800000;
+    int shift = 14 - e;
+    uint32_t h = mant >> shift;
+    uint32_t rem = mant & ((1u << shift) - 1);
+    uint32_t half = 1u << (shift - 1);
+    if (rem > half || (rem == half && (h & 1)))
+      h++;
+    return (uint16_t)(sign | h);
+  }
+  uint32_t h = ((uint32_t)e << 10) | (mant >> 13);
+  uint32_t rem = mant & 0x1fff;
+  if (rem > 0x1000 || (rem == 0x1000 && (h & 1)))
+    h++; // перенос в порядок дает корректную бесконечность
+  return (uint16_t)(sign | h);
+#endif
+}
+
+inline float HalfBitsToFloat(uint16_t h)
+{
+#if defined(__F16C__)
+  return _cvtsh_ss(h);
+#else
+  uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1f;
+  uint32_t mant = h & 0x3ff;
+  if (exp == 0)
+  {
+    float f = (float)mant * 5.9604644775390625e-8f; // mant * 2^-24
+    return sign ? -f : f;
+  }
+  if (exp == 0x1f)
+    return BitsFloat(sign | 0x7f800000 | (mant << 13));
+  return BitsFloat(sign | ((exp + 112) << 23) | (mant << 13));
+#endif
+}
+
+// float -> bfloat16 (старшие 16 бит) с округлением к ближайшему четному
+inline uint16_t FloatToBFloat16Bits(float f)
+{
+  uint32_t x = FloatBits(f);
+  if ((x & 0x7fffffff) > 0x7f800000)
+    return (uint16_t)((x >> 16) | 0x40); // тихий NaN
+  x += 0x7fff + ((x >> 16) & 1);
+  return (uint16_t)(x >> 16);
+}
+
+inline float BFloat16BitsToFloat(uint16_t h)
+{
+  return BitsFloat((uint32_t)h << 16);
+}
+
+// Общая часть 16-битных типов: хранение битов, арифметика через float.
+// Conv задает преобразования ToBits/FromBits
+template<typename Conv>
+class TFloat16Base
+{
+protected:
+  uint16_t bits;
+public:
+  TFloat16Base() : bits(0) {}
+  TFloat16Base(float f) : bits(Conv::ToBits(f)) {}
+
+  operator float() const { return Conv::FromBits(bits); }
+
+  uint16_t raw() const noexcept { return bits; }
+  static TFloat16Base from_raw(uint16_t b)
+  {
+    TFloat16Base h;
+    h.bits = b;
+    return h;
+  }
+
+  TFloat16Base& operator+=(float f) { return *this = float(*this) + f; }
+  TFloat16Base& operator-=(float f) { return *this = float(*this) - f; }
+  TFloat16Base& operator*=(float f) { return *this = float(*this) * f; }
+  TFloat16Base& operator/=(float f) { return *this = float(*this) / f; }
+
+  friend istream& operator>>(istream& istr, TFloat16Base& h)
+  {
+    float f;
+    if (istr >> f)
+      h = f;
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TFloat16Base& h)
+  {
+    return ostr << float(h);
+  }
+};
+
+struct THalfConv
+{
+  static uint16_t ToBits(float f) { return FloatToHalfBits(f); }
+  static float FromBits(uint16_t b) { return HalfBitsToFloat(b); }
+};
+
+struct TBFloat16Conv
+{
+  static uint16_t ToBits(float f) { return FloatToBFloat16Bits(f); }
+  static float FromBits(uint16_t b) { return BFloat16BitsToFloat(b); }
+};
+
+typedef TFloat16Base<THalfConv> THalf;
+typedef TFloat16Base<TBFloat16Conv> TBFloat16;
+
+// суммы 16-битных элементов накапливаются во float
+template<> struct TAccumulator<THalf> { typedef float type; };
+template<> struct TAccumulator<TBFloat16> { typedef float type; };
+
+#endif
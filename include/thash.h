@@ -0,0 +1,167 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Хеширование содержимого векторов и матриц (ключи кэшей).
+// Хеш 128-битный, не зависит от запуска, числа потоков и адресов данных
+//
+//
+
+#ifndef __THash_H__
+#define __THash_H__
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "tmatrix.h"
+
+const uint64_t HASH_PRIME1 = 0x9E3779B185EBCA87ull;
+const uint64_t HASH_PRIME2 = 0xC2B2AE3D27D4EB4Full;
+const uint64_t HASH_PRIME3 = 0x165667B19E3779F9ull;
+const uint64_t HASH_SEED = 0x243F6A8885A308D3ull;
+
+struct THash128
+{
+  uint64_t lo, hi;
+
+  bool operator==(const THash128& h) const { return lo == h.lo && hi == h.hi; }
+  bool operator!=(const THash128& h) const { return !(*this == h); }
+  bool operator<(const THash128& h) const { return hi < h.hi || (hi == h.hi && lo < h.lo); }
+};
+
+inline uint64_t HashRotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+// финальное перемешивание (splitmix64)
+inline uint64_t HashMix(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBull;
+  x ^= x >> 31;
+  return x;
+}
+
+// Хеш последовательности байт: четыре независимые полосы по 8 байт
+// (векторизуются), затем свертка полос в две 64-битные половины
+inline THash128 HashBytes(const void* data, size_t n, uint64_t seed)
+{
+  const unsigned char* p = (const unsigned char*)data;
+  uint64_t acc[4] = { seed + HASH_PRIME1, seed ^ HASH_PRIME2, seed - HASH_PRIME1, seed + HASH_PRIME3 };
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32)
+  {
+    uint64_t w[4];
+    std::memcpy(w, p + i, 32);
+    for (int l = 0; l < 4; l++)
+      acc[l] = HashRotl(acc[l] + w[l] * HASH_PRIME2, 31) * HASH_PRIME1;
+  }
+  uint64_t tail[4] = { 0, 0, 0, 0 };
+  std::memcpy(tail, p + i, n - i);
+  for (int l = 0; l < 4; l++)
+    acc[l] = HashRotl(acc[l] + tail[l] * HASH_PRIME2, 31) * HASH_PRIME1;
+
+  THash128 h;
+  h.lo = HashMix(acc[0] ^ HashRotl(acc[1], 17) ^ HashRotl(acc[2], 29) ^ HashRotl(acc[3], 43) ^ n);
+  h.hi = HashMix(acc[3] ^ HashRotl(acc[2], 13) ^ HashRotl(acc[1], 37) ^ HashRotl(acc[0], 53) ^ (n * HASH_PRIME3));
+  return h;
+}
+
+// объединение хешей соседних частей (некоммутативно)
+inline THash128 HashCombine(const THash128& a, const THash128& b)
+{
+  THash128 h;
+  h.lo = HashMix(a.lo * HASH_PRIME1 ^ HashRotl(b.lo, 23) ^ b.hi);
+  h.hi = HashMix(a.hi * HASH_PRIME3 ^ HashRotl(b.hi, 41) ^ a.lo);
+  return h;
+}
+
+inline THash128 HashFinalize(const THash128& h, size_t n)
+{
+  THash128 r;
+  r.lo = HashMix(h.lo ^ (n * HASH_PRIME2));
+  r.hi = HashMix(h.hi + n);
+  return r;
+}
+
+// Хеш вектора: блоки по REDUCE_BLOCK элементов хешируются параллельно
+// и объединяются попарным деревом. Хешируется двоичное представление
+// элементов, поэтому для вещественных типов 0.0 и -0.0 различаются
+template<typename T>
+THash128 Hash(const TDynamicVector<T>& v)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "Hash requires trivially copyable T");
+  const T* a = &v[0];
+  THash128 h = ReduceBlocks<THash128>(v.size(),
+    [a](size_t first, size_t last) { return HashBytes(a + first, (last - first) * sizeof(T), HASH_SEED); },
+    HashCombine);
+  return HashFinalize(h, v.size());
+}
+
+// Хеш матрицы с возможностью обновления после изменения строк.
+// Хранит хеши строк и все уровни дерева их объединения, изменение одной
+// строки пересчитывает только эту строку и log n узлов дерева. Матрица
+// не запоминается и передается при каждом обновлении
+template<typename T>
+class TMatrixHasher
+{
+protected:
+  size_t n, depth;
+  TDynamicVector<TDynamicVector<THash128>> levels;
+
+  void UpdatePath(size_t i)
+  {
+    for (size_t l = 1; l < depth; l++)
+    {
+      i /= 2;
+      const TDynamicVector<THash128>& below = levels[l - 1];
+      levels[l][i] = 2 * i + 1 < below.size() ? HashCombine(below[2 * i], below[2 * i + 1]) : below[2 * i];
+    }
+  }
+public:
+  explicit TMatrixHasher(const TDynamicMatrix<T>& matrix) : n(matrix.size()), depth(1)
+  {
+    for (size_t w = n; w > 1; w = (w + 1) / 2)
+      depth++;
+    levels = TDynamicVector<TDynamicVector<THash128>>(depth);
+    levels[0] = TDynamicVector<THash128>(n);
+    const int nn = (int)n;
+    #pragma omp parallel for if (n >= MATRIX_PARALLEL_SIZE)
+    for (int i = 0; i < nn; i++)
+      levels[0][i] = Hash(matrix[i]);
+    for (size_t l = 1; l < depth; l++)
+    {
+      const TDynamicVector<THash128>& below = levels[l - 1];
+      levels[l] = TDynamicVector<THash128>((below.size() + 1) / 2);
+      for (size_t i = 0; i < levels[l].size(); i++)
+        levels[l][i] = 2 * i + 1 < below.size() ? HashCombine(below[2 * i], below[2 * i + 1]) : below[2 * i];
+    }
+  }
+
+  // строка i матрицы изменилась
+  void update_row(const TDynamicMatrix<T>& matrix, size_t i)
+  {
+    if (matrix.size() != n)
+      throw length_error("Matrix sizes should be equal");
+    if (i >= n)
+      throw out_of_range("Matrix row index is out of range");
+    levels[0][i] = Hash(matrix[i]);
+    UpdatePath(i);
+  }
+
+  THash128 value() const
+  {
+    return HashFinalize(levels[depth - 1][0], n);
+  }
+};
+
+// Хеш матрицы: хеши строк, объединенные тем же деревом, что
+// и в TMatrixHasher
+template<typename T>
+THash128 Hash(const TDynamicMatrix<T>& m)
+{
+  return TMatrixHasher<T>(m).value();
+}
+
+#endif
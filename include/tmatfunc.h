@@ -0,0 +1,195 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Матричные функции: натуральная степень и многочлены от матрицы,
+// решение систем с треугольной матрицей
+//
+//
+
+#ifndef __TMatFunc_H__
+#define __TMatFunc_H__
+
+#include <cmath>
+#include "tmatrix.h"
+
+// ширина полосы столбцов правой части в TriangularSolve
+const size_t TRSM_BLOCK = 256;
+
+// Единичная матрица
+template<typename T>
+TDynamicMatrix<T> IdentityMatrix(size_t n)
+{
+  TDynamicMatrix<T> e(n);
+  for (size_t i = 0; i < n; i++)
+    e[i][i] = T(1);
+  return e;
+}
+
+// Степень A^k двоичным возведением слева направо.
+// Используются два буфера, которые меняются местами после каждого
+// произведения, память на шагах не выделяется
+template<typename T>
+TDynamicMatrix<T> pow(const TDynamicMatrix<T>& a, unsigned long long k)
+{
+  if (k == 0)
+    return IdentityMatrix<T>(a.size());
+  int bit = 63;
+  while (!((k >> bit) & 1))
+    bit--;
+  TDynamicMatrix<T> res(a), tmp(a.size());
+  for (bit--; bit >= 0; bit--)
+  {
+    res.template MultiplyInto<TPlusTimes<T>>(res, tmp);
+    swap(res, tmp);
+    if ((k >> bit) & 1)
+    {
+      res.template MultiplyInto<TPlusTimes<T>>(a, tmp);
+      swap(res, tmp);
+    }
+  }
+  return res;
+}
+
+// res += c * v (AXPY)
+template<typename T>
+void AddScaled(TDynamicVector<T>& res, const T& c, const TDynamicVector<T>& v)
+{
+  if (res.size() != v.size())
+    throw length_error("Vector sizes should be equal");
+  const size_t n = res.size();
+  T* r = res.data();
+  const T* p = v.data();
+  if (SystemAxpy(n, c, p, r))
+    return;
+  for (size_t j = 0; j < n; j++)
+    r[j] += c * p[j];
+}
+
+// res += c * m
+template<typename T>
+void AddScaled(TDynamicMatrix<T>& res, const T& c, const TDynamicMatrix<T>& m)
+{
+  if (res.size() != m.size())
+    throw length_error("Matrix sizes should be equal");
+  const size_t n = res.size();
+  for (size_t i = 0; i < n; i++)
+    AddScaled(res[i], c, m[i]);
+}
+
+// Значение многочлена c[0] E + c[1] A + ... + c[d] A^d по схеме
+// Патерсона - Стокмейера: вычисляются A^0..A^s, s ~ sqrt(d + 1), затем
+// схема Горнера по B = A^s с блоками коэффициентов длины s.
+// Требуется около 2 sqrt(d) матричных произведений вместо d
+template<typename T>
+TDynamicMatrix<T> PolynomialValue(const TDynamicVector<T>& c, const TDynamicMatrix<T>& a)
+{
+  const size_t n = a.size();
+  const size_t d = c.size() - 1;
+  size_t s = (size_t)std::sqrt((double)(d + 1));
+  if (s * s < d + 1)
+    s++;
+  if (s == 0)
+    s = 1;
+
+  // степени A^0..A^s
+  TDynamicVector<TDynamicMatrix<T>> p(s + 1);
+  p[0] = IdentityMatrix<T>(n);
+  if (s >= 1)
+    p[1] = a;
+  for (size_t i = 2; i <= s; i++)
+  {
+    p[i] = TDynamicMatrix<T>(n);
+    p[i - 1].template MultiplyInto<TPlusTimes<T>>(a, p[i]);
+  }
+
+  // Горнер по блокам: res = Q_r, res = res * B + Q_j
+  const size_t blocks = d / s + 1;
+  TDynamicMatrix<T> res(n), tmp(n);
+  for (size_t j = blocks; j-- > 0;)
+  {
+    if (j + 1 < blocks)
+    {
+      res.template MultiplyInto<TPlusTimes<T>>(p[s], tmp);
+      swap(res, tmp);
+    }
+    for (size_t i = 0; i < s && j * s + i <= d; i++)
+      if (c[j * s + i] != T())
+        AddScaled(res, c[j * s + i], p[i]);
+  }
+  return res;
+}
+
+enum TTriangle { TRIANGLE_LOWER, TRIANGLE_UPPER };
+
+inline void CheckTriangularSolve(size_t n, size_t rhs)
+{
+  if (n != rhs)
+    throw length_error("Matrix and right-hand side sizes should be equal");
+}
+
+// Решение A X = B с треугольной A, X записывается на место B.
+// Встроенная реализация - подстановка по строкам
+// X[i] = (B[i] - sum A[i][k] X[k]) / A[i][i], полосы столбцов B
+// независимы и решаются параллельно. Для float и double при выбранной
+// системной BLAS вызывается TRSM (см. tblas.h)
+template<typename T>
+void TriangularSolve(const TDynamicMatrix<T>& a, TDynamicMatrix<T>& b, TTriangle tri)
+{
+  const size_t n = a.size();
+  CheckTriangularSolve(n, b.size());
+  for (size_t i = 0; i < n; i++)
+    if (a[i][i] == T())
+      throw runtime_error("Triangular matrix is singular");
+  if (SystemTrsm<T>(n, n, tri == TRIANGLE_UPPER, [&a](size_t i) { return &a[i][0]; },
+    [&b](size_t i) { return &b[i][0]; }))
+    return;
+  const int nn = (int)n;
+  #pragma omp parallel for schedule(static) if (n >= MATRIX_PARALLEL_SIZE)
+  for (int jb = 0; jb < nn; jb += (int)TRSM_BLOCK)
+  {
+    const size_t j0 = jb, j1 = std::min(n, j0 + TRSM_BLOCK);
+    for (size_t s = 0; s < n; s++)
+    {
+      const size_t i = tri == TRIANGLE_UPPER ? n - 1 - s : s;
+      const T* ai = &a[i][0];
+      T* x = &b[i][0];
+      for (size_t t = 0; t < s; t++)
+      {
+        const size_t k = tri == TRIANGLE_UPPER ? n - 1 - t : t;
+        const T c = ai[k];
+        const T* xk = &b[k][0];
+        for (size_t j = j0; j < j1; j++)
+          x[j] -= c * xk[j];
+      }
+      for (size_t j = j0; j < j1; j++)
+        x[j] /= ai[i];
+    }
+  }
+}
+
+// то же для одной правой части: A x = b, x записывается на место b
+template<typename T>
+void TriangularSolve(const TDynamicMatrix<T>& a, TDynamicVector<T>& b, TTriangle tri)
+{
+  const size_t n = a.size();
+  CheckTriangularSolve(n, b.size());
+  for (size_t i = 0; i < n; i++)
+    if (a[i][i] == T())
+      throw runtime_error("Triangular matrix is singular");
+  T* x = b.data();
+  if (SystemTrsm<T>(n, 1, tri == TRIANGLE_UPPER, [&a](size_t i) { return &a[i][0]; }, [x](size_t i) { return x + i; }))
+    return;
+  for (size_t s = 0; s < n; s++)
+  {
+    const size_t i = tri == TRIANGLE_UPPER ? n - 1 - s : s;
+    const T* ai = &a[i][0];
+    T r = x[i];
+    for (size_t t = 0; t < s; t++)
+    {
+      const size_t k = tri == TRIANGLE_UPPER ? n - 1 - t : t;
+      r -= ai[k] * x[k];
+    }
+    x[i] = r / ai[i];
+  }
+}
+
+#endif
@@ -8,111 +8,871 @@
 #define __TDynamicMatrix_H__
 
 #include <iostream>
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <limits>
+#include <cmath>
+#include <utility>
+#include <atomic>
+#include <cstring>
+#include <climits>
+#include <new>
+#include <exception>
+#include <iterator>
+#include <cstddef>
+#include <array>
+#include "tnuma.h"
+#include "talloc.h"
+#include "tblas.h"
+#include "tprofile.h"
+#include "ttune.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+#ifdef __cpp_lib_span
+#include <span>
+#endif
+#ifdef __cpp_lib_mdspan
+#include <mdspan>
+#endif
 
 using namespace std;
 
 const int MAX_VECTOR_SIZE = 100000000;
 const int MAX_MATRIX_SIZE = 10000;
+static_assert(TUNING_MAX_BLOCK == (size_t)MAX_MATRIX_SIZE, "Tuning block bound should match MAX_MATRIX_SIZE");
+
+// Контроль индексов в operator[] (at() проверяет индекс всегда):
+//  TMATRIX_BOUNDS_OFF - без проверок, operator[] - простое обращение к памяти;
+//  TMATRIX_BOUNDS_ALL - проверяется каждое обращение;
+//  TMATRIX_BOUNDS_SAMPLE - проверяется каждое TMATRIX_BOUNDS_SAMPLE_PERIOD-е
+//    обращение в потоке (дешевый выборочный контроль в рабочей сборке).
+// По умолчанию - TMATRIX_BOUNDS_ALL в отладочной сборке и
+// TMATRIX_BOUNDS_OFF при NDEBUG
+#define TMATRIX_BOUNDS_OFF 0
+#define TMATRIX_BOUNDS_ALL 1
+#define TMATRIX_BOUNDS_SAMPLE 2
+
+#ifndef TMATRIX_BOUNDS_CHECK
+#ifdef NDEBUG
+#define TMATRIX_BOUNDS_CHECK TMATRIX_BOUNDS_OFF
+#else
+#define TMATRIX_BOUNDS_CHECK TMATRIX_BOUNDS_ALL
+#endif
+#endif
+
+#ifndef TMATRIX_BOUNDS_SAMPLE_PERIOD
+#define TMATRIX_BOUNDS_SAMPLE_PERIOD 64
+#endif
+
+// нужно ли проверять текущее обращение operator[]
+inline bool BoundsCheckDue()
+{
+#if TMATRIX_BOUNDS_CHECK == TMATRIX_BOUNDS_SAMPLE
+  static thread_local unsigned counter = 0;
+  return ++counter % TMATRIX_BOUNDS_SAMPLE_PERIOD == 0;
+#else
+  return TMATRIX_BOUNDS_CHECK == TMATRIX_BOUNDS_ALL;
+#endif
+}
+
+// Детерминированные редукции.
+// Данные делятся на листья фиксированной длины REDUCE_BLOCK, внутри листа
+// сумма накапливается в REDUCE_LANES независимых частичных суммах, листья
+// объединяются попарным деревом. Форма дерева зависит только от длины,
+// поэтому результат не зависит от числа потоков и ширины SIMD.
+// Листья считаются параллельно, начиная с Tuning().reduce_parallel_blocks
+// листов (ttune.h)
+const size_t REDUCE_BLOCK = 4096;
+const size_t REDUCE_LANES = 8;
+
+// Тип, в котором накапливаются суммы элементов типа T
+// (для 16-битных вещественных типов - float, см. thalf.h)
+template<typename T>
+struct TAccumulator
+{
+  typedef T type;
+};
+
+template<typename T>
+T AbsValue(const T& x)
+{
+  return x < T() ? T(-x) : x;
+}
+
+// попарное сложение part[0..n) на месте, результат в part[0]
+template<typename T, typename Combine>
+T PairwiseReduce(T* part, size_t n, Combine comb)
+{
+  for (size_t step = 1; step < n; step *= 2)
+    for (size_t i = 0; i + step < n; i += 2 * step)
+      part[i] = comb(part[i], part[i + step]);
+  return part[0];
+}
+
+// сумма term(i) по листу [first, last)
+template<typename T, typename Term>
+T LeafSum(size_t first, size_t last, Term term)
+{
+  T acc[REDUCE_LANES];
+  for (size_t l = 0; l < REDUCE_LANES; l++)
+    acc[l] = T();
+  size_t i = first;
+  for (; i + REDUCE_LANES <= last; i += REDUCE_LANES)
+    for (size_t l = 0; l < REDUCE_LANES; l++)
+      acc[l] += term(i + l);
+  for (size_t l = 0; i < last; i++, l++)
+    acc[l] += term(i);
+  return PairwiseReduce(acc, REDUCE_LANES, [](const T& a, const T& b) { return a + b; });
+}
+
+// leaf(first, last) вычисляет значение листа, comb объединяет два значения
+template<typename T, typename Leaf, typename Combine>
+T ReduceBlocks(size_t n, Leaf leaf, Combine comb)
+{
+  const size_t nb = (n + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+  if (nb <= 1)
+    return leaf(0, n);
+  T* part = new T[nb];
+  const int nblocks = (int)nb;
+  #pragma omp parallel if (nb >= Tuning().reduce_parallel_blocks)
+  {
+    TMATRIX_CHUNK_SCOPE("reduce blocks", nb);
+    #pragma omp for nowait
+    for (int b = 0; b < nblocks; b++)
+      part[b] = leaf(b * REDUCE_BLOCK, std::min(n, (b + 1) * REDUCE_BLOCK));
+  }
+  T res = PairwiseReduce(part, nb, comb);
+  delete[] part;
+  return res;
+}
+
+// Циклы по строкам матриц от этого размера выполняются параллельно
+const size_t MATRIX_PARALLEL_SIZE = 64;
+
+// Полукольца для TDynamicMatrix::Multiply.
+// acc_type - тип накопления, zero() - нейтральный элемент сложения
+
+// обычная арифметика (+, *)
+template<typename T>
+struct TPlusTimes
+{
+  typedef typename TAccumulator<T>::type acc_type;
+  static acc_type zero() { return acc_type(); }
+  static acc_type add(const acc_type& a, const acc_type& b) { return a + b; }
+  static acc_type mul(const acc_type& a, const acc_type& b) { return a * b; }
+};
+
+// тропическое (min, +): кратчайшие пути, zero() - "нет пути"
+template<typename T>
+struct TMinPlus
+{
+  typedef T acc_type;
+  static T zero()
+  {
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+  }
+  static T add(const T& a, const T& b) { return b < a ? b : a; }
+  // бесконечность сохраняется сложением, проверка нужна только без нее
+  static T mul(const T& a, const T& b)
+  {
+    if (std::numeric_limits<T>::has_infinity)
+      return a + b;
+    return (a == zero() || b == zero()) ? zero() : a + b;
+  }
+};
+
+// (max, +): самые длинные (критические) пути
+template<typename T>
+struct TMaxPlus
+{
+  typedef T acc_type;
+  static T zero()
+  {
+    return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+  }
+  static T add(const T& a, const T& b) { return a < b ? b : a; }
+  static T mul(const T& a, const T& b)
+  {
+    if (std::numeric_limits<T>::has_infinity)
+      return a + b;
+    return (a == zero() || b == zero()) ? zero() : a + b;
+  }
+};
+
+// (max, min): пути с максимальной пропускной способностью
+template<typename T>
+struct TMaxMin
+{
+  typedef T acc_type;
+  static T zero()
+  {
+    return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+  }
+  static T add(const T& a, const T& b) { return a < b ? b : a; }
+  static T mul(const T& a, const T& b) { return b < a ? b : a; }
+};
+
+// Сравнение.
+// Целочисленные элементы сравниваются побайтно (memcmp), остальные -
+// поэлементно. Длинные данные делятся на блоки, блоки проверяются
+// параллельно, после первого несовпадения остальные блоки пропускаются
+const size_t COMPARE_BLOCK = 1 << 14;
+
+template<typename T>
+struct TBitwiseComparable : std::integral_constant<bool,
+  std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value>
+{
+};
+
+template<typename T>
+bool RangeEqual(const T* a, const T* b, size_t n, std::true_type)
+{
+  return std::memcmp(a, b, n * sizeof(T)) == 0;
+}
+
+template<typename T>
+bool RangeEqual(const T* a, const T* b, size_t n, std::false_type)
+{
+  for (size_t i = 0; i < n; i++)
+    if (a[i] != b[i])
+      return false;
+  return true;
+}
+
+// pred(first, last) для блоков [0, n) длины block; unit - число
+// элементов в единице длины (например, в строке матрицы), блоки
+// проверяются параллельно от COMPARE_BLOCK элементов
+template<typename Pred>
+bool AllBlocks(size_t n, size_t block, Pred pred, size_t unit = 1)
+{
+  const size_t nb = (n + block - 1) / block;
+  if (nb <= 1)
+    return pred(0, n);
+  std::atomic<bool> ok(true);
+  const int nblocks = (int)nb;
+  #pragma omp parallel if (n * unit >= COMPARE_BLOCK)
+  {
+    TMATRIX_CHUNK_SCOPE("compare blocks", nb);
+    #pragma omp for schedule(dynamic) nowait
+    for (int b = 0; b < nblocks; b++)
+    {
+      if (!ok.load(std::memory_order_relaxed))
+        continue;
+      if (!pred(b * block, std::min(n, (b + 1) * block)))
+        ok.store(false, std::memory_order_relaxed);
+    }
+  }
+  return ok.load();
+}
+
+// расстояние в единицах последнего разряда, для не-вещественных типов
+// не определено
+template<typename T>
+unsigned long long UlpDistance(const T&, const T&)
+{
+  return ~0ull;
+}
+
+inline unsigned long long UlpDistance(double a, double b)
+{
+  if (a != a || b != b)
+    return ~0ull;
+  long long x, y;
+  std::memcpy(&x, &a, sizeof(x));
+  std::memcpy(&y, &b, sizeof(y));
+  // отображение в монотонную целочисленную шкалу
+  if (x < 0)
+    x = LLONG_MIN - x;
+  if (y < 0)
+    y = LLONG_MIN - y;
+  return x > y ? (unsigned long long)x - (unsigned long long)y : (unsigned long long)y - (unsigned long long)x;
+}
+
+inline unsigned long long UlpDistance(float a, float b)
+{
+  if (a != a || b != b)
+    return ~0ull;
+  int x, y;
+  std::memcpy(&x, &a, sizeof(x));
+  std::memcpy(&y, &b, sizeof(y));
+  long long u = x < 0 ? (long long)INT_MIN - x : x;
+  long long v = y < 0 ? (long long)INT_MIN - y : y;
+  return (unsigned long long)(u > v ? u - v : v - u);
+}
+
+template<typename T>
+bool ApproxEqual(const T& a, const T& b, const T& abs_tol, const T& rel_tol, unsigned long long ulps)
+{
+  if (a == b)
+    return true;
+  T d = AbsValue(T(a - b));
+  if (d <= abs_tol)
+    return true;
+  T m = std::max(AbsValue(a), AbsValue(b));
+  if (d <= T(rel_tol * m))
+    return true;
+  return ulps > 0 && UlpDistance(a, b) <= ulps;
+}
+
+// Теги конструкторов: без инициализации элементов (для тривиальных
+// типов память не обнуляется), заполнение значением, заполнение
+// значениями функции-генератора от индексов
+struct TUninitTag {};
+struct TFillTag {};
+struct TGenerateTag {};
+const TUninitTag UNINITIALIZED = TUninitTag();
+const TFillTag FILL = TFillTag();
+const TGenerateTag GENERATE = TGenerateTag();
+
+// Теги конструкторов для внешних буферов: представление без владения
+// (память остается у вызывающего и должна жить дольше вектора) и передача
+// владения с функцией освобождения
+struct TViewTag {};
+struct TAdoptTag {};
+const TViewTag VIEW = TViewTag();
+const TAdoptTag ADOPT = TAdoptTag();
+
+// Освобождение принятого внешнего буфера
+template<typename T>
+struct TBufferRelease
+{
+  virtual ~TBufferRelease() {}
+  virtual void release(T* p) noexcept = 0;
+};
+
+template<typename T, typename D>
+struct TBufferDeleter : TBufferRelease<T>
+{
+  D d;
+  explicit TBufferDeleter(D deleter) : d(std::move(deleter)) {}
+  void release(T* p) noexcept { d(p); }
+};
+
+template<typename T>
+struct TBufferNoRelease : TBufferRelease<T>
+{
+  void release(T*) noexcept {}
+};
+
+// Служебные теги: пустая строка без памяти под элементы и массив пустых
+// строк матрицы, которые затем выделяет TDynamicMatrix::CreateRows
+struct TEmptyRowTag {};
+struct TRowArrayTag {};
+
+// Освобождение массива строк, размещенного в сырой памяти
+template<typename T>
+struct TRowArrayRelease : TBufferRelease<T>
+{
+  size_t n;
+  explicit TRowArrayRelease(size_t count) : n(count) {}
+  void release(T* p) noexcept
+  {
+    for (size_t i = 0; i < n; i++)
+      p[i].~T();
+    ::operator delete(p);
+  }
+};
+
+template<typename T> class TDynamicMatrix;
 
 // Динамический вектор - 
 // шаблонный вектор на динамической памяти
 template<typename T>
 class TDynamicVector
 {
+  template<typename> friend class TDynamicMatrix;
+  template<typename> friend class TDynamicVector;
 protected:
   size_t sz;
   T* pMem;
+  // nullptr - собственная память (AllocArray), ViewRelease() - чужая
+  // память без владения, иначе - принятый буфер со своим освобождением
+  TBufferRelease<T>* ext = nullptr;
+
+  static void CheckSize(size_t size)
+  {
+    if (size == 0)
+      throw out_of_range("Vector size should be greater than zero");
+    if (size > MAX_VECTOR_SIZE)
+      throw out_of_range("Vector size should be less than MAX_VECTOR_SIZE");
+  }
+  static TBufferRelease<T>* ViewRelease()
+  {
+    static TBufferNoRelease<T> r;
+    return &r;
+  }
+  void Release() noexcept
+  {
+    if (ext == nullptr)
+      FreeArray(pMem);
+    else if (ext != ViewRelease())
+    {
+      ext->release(pMem);
+      delete ext;
+    }
+    ext = nullptr;
+  }
+  TDynamicVector(TEmptyRowTag) noexcept : sz(0), pMem(nullptr) {}
+  // size пустых строк (T - TDynamicVector<U>) без выделения памяти под
+  // их элементы
+  TDynamicVector(size_t size, TRowArrayTag) : sz(size)
+  {
+    CheckSize(sz);
+    ext = new TRowArrayRelease<T>(sz);
+    try
+    {
+      pMem = static_cast<T*>(::operator new(sz * sizeof(T)));
+    }
+    catch (...)
+    {
+      delete ext;
+      throw;
+    }
+    for (size_t i = 0; i < sz; i++)
+      new (pMem + i) T(TEmptyRowTag());
+  }
 public:
   TDynamicVector(size_t size = 1) : sz(size)
   {
-    if (sz == 0)
-      throw out_of_range("Vector size should be greater than zero");
-    pMem = new T[sz]();// {}; // У типа T д.б. констуктор по умолчанию
+    CheckSize(sz);
+    pMem = AllocArray<T>(sz); // У типа T д.б. констуктор по умолчанию
+    std::fill(pMem, pMem + sz, T());
+  }
+  TDynamicVector(size_t size, TUninitTag) : sz(size)
+  {
+    CheckSize(sz);
+    pMem = AllocArray<T>(sz);
+  }
+  TDynamicVector(size_t size, TFillTag, const T& val) : sz(size)
+  {
+    CheckSize(sz);
+    pMem = AllocArray<T>(sz);
+    std::fill(pMem, pMem + sz, val);
   }
+  // pMem[i] = gen(i)
+  template<typename Gen>
+  TDynamicVector(size_t size, TGenerateTag, Gen gen) : sz(size)
+  {
+    CheckSize(sz);
+    pMem = AllocArray<T>(sz);
+    for (size_t i = 0; i < sz; i++)
+      pMem[i] = gen(i);
+  }
+  // копия массива arr
   TDynamicVector(T* arr, size_t s) : sz(s)
   {
     assert(arr != nullptr && "TDynamicVector ctor requires non-nullptr arg");
-    pMem = new T[sz];
+    pMem = AllocArray<T>(sz);
     std::copy(arr, arr + sz, pMem);
   }
-  TDynamicVector(const TDynamicVector& v)
+  // представление массива arr без копирования и владения
+  TDynamicVector(T* arr, size_t s, TViewTag) : sz(s), pMem(arr)
+  {
+    if (arr == nullptr)
+      throw invalid_argument("TDynamicVector view requires non-nullptr arg");
+    CheckSize(sz);
+    ext = ViewRelease();
+  }
+  // вектор становится владельцем arr и освобождает его вызовом deleter(arr);
+  // при ошибке конструктора arr освобождается сразу
+  template<typename D>
+  TDynamicVector(T* arr, size_t s, TAdoptTag, D deleter) : sz(s), pMem(arr)
+  {
+    try
+    {
+      if (arr == nullptr)
+        throw invalid_argument("TDynamicVector adopt requires non-nullptr arg");
+      CheckSize(sz);
+      ext = new TBufferDeleter<T, D>(deleter);
+    }
+    catch (...)
+    {
+      if (arr != nullptr)
+        deleter(arr);
+      throw;
+    }
+  }
+#ifdef __cpp_lib_span
+  TDynamicVector(std::span<T> s, TViewTag) : TDynamicVector(s.data(), s.size(), VIEW) {}
+#endif
+  TDynamicVector(const TDynamicVector& v) : sz(v.sz)
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_COPY, sz, sz, 0, 2 * sz * sizeof(T), 1);
+    pMem = AllocArray<T>(sz);
+    std::copy(v.pMem, v.pMem + sz, pMem);
   }
-  TDynamicVector(TDynamicVector&& v) noexcept
+  TDynamicVector(TDynamicVector&& v) noexcept : sz(0), pMem(nullptr)
   {
+    swap(*this, v);
   }
   ~TDynamicVector()
   {
+    Release();
   }
   TDynamicVector& operator=(const TDynamicVector& v)
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_COPY, v.sz, v.sz, 0, 2 * v.sz * sizeof(T), sz != v.sz && this != &v);
+    if (this == &v)
+      return *this;
+    if (sz != v.sz)
+    {
+      T* p = AllocArray<T>(v.sz);
+      Release();
+      pMem = p;
+      sz = v.sz;
+    }
+    std::copy(v.pMem, v.pMem + sz, pMem);
+    return *this;
   }
   TDynamicVector& operator=(TDynamicVector&& v) noexcept
   {
+    swap(*this, v);
+    return *this;
   }
 
   size_t size() const noexcept { return sz; }
+  // false для представления чужой памяти (VIEW)
+  bool owns() const noexcept { return ext != ViewRelease(); }
+
+#ifdef __cpp_lib_span
+  operator std::span<T>() noexcept { return std::span<T>(pMem, sz); }
+  operator std::span<const T>() const noexcept { return std::span<const T>(pMem, sz); }
+#endif
+
+  // непрерывные итераторы (подходят для параллельных алгоритмов STL)
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
 
-  // индексация
+  T* data() noexcept { return pMem; }
+  const T* data() const noexcept { return pMem; }
+  iterator begin() noexcept { return pMem; }
+  iterator end() noexcept { return pMem + sz; }
+  const_iterator begin() const noexcept { return pMem; }
+  const_iterator end() const noexcept { return pMem + sz; }
+  const_iterator cbegin() const noexcept { return pMem; }
+  const_iterator cend() const noexcept { return pMem + sz; }
+
+  // индексация, контроль задается TMATRIX_BOUNDS_CHECK
   T& operator[](size_t ind)
   {
+#if TMATRIX_BOUNDS_CHECK != TMATRIX_BOUNDS_OFF
+    if (BoundsCheckDue() && ind >= sz)
+      throw out_of_range("Vector index is out of range");
+#endif
+    return pMem[ind];
   }
   const T& operator[](size_t ind) const
   {
+#if TMATRIX_BOUNDS_CHECK != TMATRIX_BOUNDS_OFF
+    if (BoundsCheckDue() && ind >= sz)
+      throw out_of_range("Vector index is out of range");
+#endif
+    return pMem[ind];
   }
   // индексация с контролем
   T& at(size_t ind)
   {
+    if (ind >= sz)
+      throw out_of_range("Vector index is out of range");
+    return pMem[ind];
   }
   const T& at(size_t ind) const
   {
+    if (ind >= sz)
+      throw out_of_range("Vector index is out of range");
+    return pMem[ind];
   }
 
   // сравнение
   bool operator==(const TDynamicVector& v) const noexcept
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_COMPARE, sz, sz, 0, 2 * sz * sizeof(T), 0);
+    if (sz != v.sz)
+      return false;
+    const T* a = pMem;
+    const T* b = v.pMem;
+    return AllBlocks(sz, COMPARE_BLOCK, [a, b](size_t first, size_t last)
+      { return RangeEqual(a + first, b + first, last - first, TBitwiseComparable<T>()); });
   }
   bool operator!=(const TDynamicVector& v) const noexcept
   {
+    return !(*this == v);
+  }
+  // приближенное сравнение: элементы равны, если отличаются не более чем
+  // на abs_tol, на rel_tol от большего по модулю или на ulps единиц
+  // последнего разряда (для float и double)
+  bool approx_equal(const TDynamicVector& v, T abs_tol, T rel_tol = T(), unsigned long long ulps = 0) const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_COMPARE, sz, sz, 3 * sz, 2 * sz * sizeof(T), 0);
+    if (sz != v.sz)
+      return false;
+    const T* a = pMem;
+    const T* b = v.pMem;
+    return AllBlocks(sz, COMPARE_BLOCK, [=](size_t first, size_t last)
+    {
+      for (size_t i = first; i < last; i++)
+        if (!ApproxEqual(a[i], b[i], abs_tol, rel_tol, ulps))
+          return false;
+      return true;
+    });
   }
 
-  // скалярные операции
-  TDynamicVector operator+(T val)
+  // скалярные операции. Перегрузки для временных операндов (&&)
+  // вычисляют результат в буфере операнда и возвращают его перемещением,
+  // поэтому цепочка (a + b) * 2 - c выделяет память один раз.
+  // Буфер представления (VIEW) не переиспользуется
+  TDynamicVector operator+(T val) const &
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_SCALAR, sz, sz, sz, 2 * sz * sizeof(T), 1);
+    TDynamicVector res(sz, UNINITIALIZED);
+    for (size_t i = 0; i < sz; i++)
+      res.pMem[i] = pMem[i] + val;
+    return res;
   }
-  TDynamicVector operator-(T val)
+  TDynamicVector operator+(T val) &&
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_SCALAR, sz, sz, sz, 2 * sz * sizeof(T), 0);
+    if (!owns())
+      return static_cast<const TDynamicVector&>(*this) + val;
+    for (size_t i = 0; i < sz; i++)
+      pMem[i] = pMem[i] + val;
+    return std::move(*this);
   }
-  TDynamicVector operator*(T val)
+  TDynamicVector operator-(T val) const &
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_SCALAR, sz, sz, sz, 2 * sz * sizeof(T), 1);
+    TDynamicVector res(sz, UNINITIALIZED);
+    for (size_t i = 0; i < sz; i++)
+      res.pMem[i] = pMem[i] - val;
+    return res;
+  }
+  TDynamicVector operator-(T val) &&
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_SCALAR, sz, sz, sz, 2 * sz * sizeof(T), 0);
+    if (!owns())
+      return static_cast<const TDynamicVector&>(*this) - val;
+    for (size_t i = 0; i < sz; i++)
+      pMem[i] = pMem[i] - val;
+    return std::move(*this);
+  }
+  TDynamicVector operator*(T val) const &
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_SCALAR, sz, sz, sz, 2 * sz * sizeof(T), 1);
+    TDynamicVector res(sz, UNINITIALIZED);
+    for (size_t i = 0; i < sz; i++)
+      res.pMem[i] = pMem[i] * val;
+    return res;
+  }
+  TDynamicVector operator*(T val) &&
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_SCALAR, sz, sz, sz, 2 * sz * sizeof(T), 0);
+    if (!owns())
+      return static_cast<const TDynamicVector&>(*this) * val;
+    for (size_t i = 0; i < sz; i++)
+      pMem[i] = pMem[i] * val;
+    return std::move(*this);
   }
 
   // векторные операции
-  TDynamicVector operator+(const TDynamicVector& v)
+  TDynamicVector operator+(const TDynamicVector& v) const &
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_ADD, sz, sz, sz, 3 * sz * sizeof(T), 1);
+    if (sz != v.sz)
+      throw length_error("Vector sizes should be equal");
+    TDynamicVector res(sz, UNINITIALIZED);
+    for (size_t i = 0; i < sz; i++)
+      res.pMem[i] = pMem[i] + v.pMem[i];
+    return res;
+  }
+  TDynamicVector operator+(const TDynamicVector& v) &&
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_ADD, sz, sz, sz, 3 * sz * sizeof(T), 0);
+    if (!owns())
+      return static_cast<const TDynamicVector&>(*this) + v;
+    if (sz != v.sz)
+      throw length_error("Vector sizes should be equal");
+    for (size_t i = 0; i < sz; i++)
+      pMem[i] = pMem[i] + v.pMem[i];
+    return std::move(*this);
+  }
+  TDynamicVector operator+(TDynamicVector&& v) const &
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_ADD, sz, sz, sz, 3 * sz * sizeof(T), 0);
+    if (!v.owns())
+      return *this + static_cast<const TDynamicVector&>(v);
+    if (sz != v.sz)
+      throw length_error("Vector sizes should be equal");
+    for (size_t i = 0; i < sz; i++)
+      v.pMem[i] = pMem[i] + v.pMem[i];
+    return std::move(v);
+  }
+  TDynamicVector operator+(TDynamicVector&& v) &&
+  {
+    return std::move(*this) + static_cast<const TDynamicVector&>(v);
+  }
+  TDynamicVector operator-(const TDynamicVector& v) const &
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_SUB, sz, sz, sz, 3 * sz * sizeof(T), 1);
+    if (sz != v.sz)
+      throw length_error("Vector sizes should be equal");
+    TDynamicVector res(sz, UNINITIALIZED);
+    for (size_t i = 0; i < sz; i++)
+      res.pMem[i] = pMem[i] - v.pMem[i];
+    return res;
+  }
+  TDynamicVector operator-(const TDynamicVector& v) &&
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_SUB, sz, sz, sz, 3 * sz * sizeof(T), 0);
+    if (!owns())
+      return static_cast<const TDynamicVector&>(*this) - v;
+    if (sz != v.sz)
+      throw length_error("Vector sizes should be equal");
+    for (size_t i = 0; i < sz; i++)
+      pMem[i] = pMem[i] - v.pMem[i];
+    return std::move(*this);
+  }
+  TDynamicVector operator-(TDynamicVector&& v) const &
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_SUB, sz, sz, sz, 3 * sz * sizeof(T), 0);
+    if (!v.owns())
+      return *this - static_cast<const TDynamicVector&>(v);
+    if (sz != v.sz)
+      throw length_error("Vector sizes should be equal");
+    for (size_t i = 0; i < sz; i++)
+      v.pMem[i] = pMem[i] - v.pMem[i];
+    return std::move(v);
+  }
+  TDynamicVector operator-(TDynamicVector&& v) &&
+  {
+    return std::move(*this) - static_cast<const TDynamicVector&>(v);
+  }
+  // скалярное произведение (для float и double - системной BLAS, если
+  // она выбрана, см. tblas.h)
+  T operator*(const TDynamicVector& v) const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_DOT, sz, sz, 2 * sz, 2 * sz * sizeof(T), 0);
+    if (sz != v.sz)
+      throw length_error("Vector sizes should be equal");
+    T res;
+    if (SystemDot(sz, pMem, v.pMem, res))
+      return res;
+    typedef typename TAccumulator<T>::type A;
+    const T* a = pMem;
+    const T* b = v.pMem;
+    return T(ReduceBlocks<A>(sz,
+      [a, b](size_t first, size_t last) { return LeafSum<A>(first, last, [a, b](size_t i) { return A(a[i]) * A(b[i]); }); },
+      [](const A& x, const A& y) { return x + y; }));
+  }
+
+  // редукции (детерминированные, см. ReduceBlocks)
+  T sum() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_REDUCE, sz, sz, sz, sz * sizeof(T), 0);
+    typedef typename TAccumulator<T>::type A;
+    const T* a = pMem;
+    return T(ReduceBlocks<A>(sz,
+      [a](size_t first, size_t last) { return LeafSum<A>(first, last, [a](size_t i) { return A(a[i]); }); },
+      [](const A& x, const A& y) { return x + y; }));
+  }
+  T min() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_REDUCE, sz, sz, sz, sz * sizeof(T), 0);
+    const T* a = pMem;
+    return ReduceBlocks<T>(sz,
+      [a](size_t first, size_t last) { return *std::min_element(a + first, a + last); },
+      [](const T& x, const T& y) { return y < x ? y : x; });
+  }
+  T max() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_REDUCE, sz, sz, sz, sz * sizeof(T), 0);
+    const T* a = pMem;
+    return ReduceBlocks<T>(sz,
+      [a](size_t first, size_t last) { return *std::max_element(a + first, a + last); },
+      [](const T& x, const T& y) { return x < y ? y : x; });
+  }
+  // индекс первого наибольшего/наименьшего элемента
+  size_t argmax() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_REDUCE, sz, sz, sz, sz * sizeof(T), 0);
+    const T* a = pMem;
+    return ReduceBlocks<size_t>(sz,
+      [a](size_t first, size_t last) { return size_t(std::max_element(a + first, a + last) - a); },
+      [a](size_t x, size_t y) { return a[x] < a[y] ? y : x; });
+  }
+  size_t argmin() const
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_REDUCE, sz, sz, sz, sz * sizeof(T), 0);
+    const T* a = pMem;
+    return ReduceBlocks<size_t>(sz,
+      [a](size_t first, size_t last) { return size_t(std::min_element(a + first, a + last) - a); },
+      [a](size_t x, size_t y) { return a[y] < a[x] ? y : x; });
   }
-  TDynamicVector operator-(const TDynamicVector& v)
+
+  // нормы
+  T norm1() const
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_REDUCE, sz, sz, sz, sz * sizeof(T), 0);
+    typedef typename TAccumulator<T>::type A;
+    const T* a = pMem;
+    return T(ReduceBlocks<A>(sz,
+      [a](size_t first, size_t last) { return LeafSum<A>(first, last, [a](size_t i) { return AbsValue(A(a[i])); }); },
+      [](const A& x, const A& y) { return x + y; }));
   }
-  T operator*(const TDynamicVector& v) noexcept(noexcept(T()))
+  T norm2() const
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_REDUCE, sz, sz, sz, sz * sizeof(T), 0);
+    typedef typename TAccumulator<T>::type A;
+    const T* a = pMem;
+    A sq = ReduceBlocks<A>(sz,
+      [a](size_t first, size_t last) { return LeafSum<A>(first, last, [a](size_t i) { return A(a[i]) * A(a[i]); }); },
+      [](const A& x, const A& y) { return x + y; });
+    return T(std::sqrt(sq));
+  }
+  T norm_inf() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_REDUCE, sz, sz, sz, sz * sizeof(T), 0);
+    const T* a = pMem;
+    return ReduceBlocks<T>(sz,
+      [a](size_t first, size_t last)
+      {
+        T res = T();
+        for (size_t i = first; i < last; i++)
+        {
+          T v = AbsValue(a[i]);
+          res = res < v ? v : res;
+        }
+        return res;
+      },
+      [](const T& x, const T& y) { return x < y ? y : x; });
   }
 
   friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
   {
     std::swap(lhs.sz, rhs.sz);
     std::swap(lhs.pMem, rhs.pMem);
+    std::swap(lhs.ext, rhs.ext);
   }
 
   // ввод/вывод
   friend istream& operator>>(istream& istr, TDynamicVector& v)
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_IO, v.sz, v.sz, 0, v.sz * sizeof(T), 0);
     for (size_t i = 0; i < v.sz; i++)
       istr >> v.pMem[i]; // требуется оператор>> для типа T
     return istr;
   }
   friend ostream& operator<<(ostream& ostr, const TDynamicVector& v)
   {
+    TMATRIX_PROFILE_SCOPE(PROF_VECTOR_IO, v.sz, v.sz, 0, v.sz * sizeof(T), 0);
     for (size_t i = 0; i < v.sz; i++)
       ostr << v.pMem[i] << ' '; // требуется оператор<< для типа T
     return ostr;
@@ -120,6 +880,83 @@ public:
 };
 
 
+// Итератор произвольного доступа по элементам матрицы в порядке строк.
+// Строки лежат в отдельных буферах, поэтому итератор хранит номера строки
+// и столбца: ++ и -- обходятся без деления, деление нужно только при
+// переходе на произвольное расстояние
+template<typename T, typename Row>
+class TMatrixElementIterator
+{
+  template<typename, typename> friend class TMatrixElementIterator;
+
+  Row* rows;
+  size_t n, i, j;
+public:
+  typedef random_access_iterator_tag iterator_category;
+  typedef typename remove_const<T>::type value_type;
+  typedef ptrdiff_t difference_type;
+  typedef T* pointer;
+  typedef T& reference;
+
+  TMatrixElementIterator() noexcept : rows(nullptr), n(1), i(0), j(0) {}
+  TMatrixElementIterator(Row* r, size_t size, size_t k) noexcept : rows(r), n(size), i(k / size), j(k % size) {}
+  // неконстантный итератор приводится к константному
+  template<typename U, typename R, typename = typename enable_if<is_convertible<U*, T*>::value>::type>
+  TMatrixElementIterator(const TMatrixElementIterator<U, R>& it) noexcept : rows(it.rows), n(it.n), i(it.i), j(it.j) {}
+
+  // номер элемента в порядке строк
+  size_t index() const noexcept { return i * n + j; }
+
+  reference operator*() const { return rows[i].data()[j]; }
+  pointer operator->() const { return rows[i].data() + j; }
+  reference operator[](difference_type d) const { return *(*this + d); }
+
+  TMatrixElementIterator& operator++() noexcept
+  {
+    if (++j == n)
+    {
+      j = 0;
+      i++;
+    }
+    return *this;
+  }
+  TMatrixElementIterator operator++(int) noexcept { TMatrixElementIterator t(*this); ++*this; return t; }
+  TMatrixElementIterator& operator--() noexcept
+  {
+    if (j == 0)
+    {
+      j = n;
+      i--;
+    }
+    j--;
+    return *this;
+  }
+  TMatrixElementIterator operator--(int) noexcept { TMatrixElementIterator t(*this); --*this; return t; }
+  TMatrixElementIterator& operator+=(difference_type d) noexcept
+  {
+    const size_t k = index() + (size_t)d;
+    i = k / n;
+    j = k % n;
+    return *this;
+  }
+  TMatrixElementIterator& operator-=(difference_type d) noexcept { return *this += -d; }
+
+  friend TMatrixElementIterator operator+(TMatrixElementIterator it, difference_type d) noexcept { return it += d; }
+  friend TMatrixElementIterator operator+(difference_type d, TMatrixElementIterator it) noexcept { return it += d; }
+  friend TMatrixElementIterator operator-(TMatrixElementIterator it, difference_type d) noexcept { return it -= d; }
+  friend difference_type operator-(const TMatrixElementIterator& a, const TMatrixElementIterator& b) noexcept
+  {
+    return (difference_type)a.index() - (difference_type)b.index();
+  }
+
+  friend bool operator==(const TMatrixElementIterator& a, const TMatrixElementIterator& b) noexcept { return a.i == b.i && a.j == b.j; }
+  friend bool operator!=(const TMatrixElementIterator& a, const TMatrixElementIterator& b) noexcept { return !(a == b); }
+  friend bool operator<(const TMatrixElementIterator& a, const TMatrixElementIterator& b) noexcept { return a.index() < b.index(); }
+  friend bool operator>(const TMatrixElementIterator& a, const TMatrixElementIterator& b) noexcept { return b < a; }
+  friend bool operator<=(const TMatrixElementIterator& a, const TMatrixElementIterator& b) noexcept { return !(b < a); }
+  friend bool operator>=(const TMatrixElementIterator& a, const TMatrixElementIterator& b) noexcept { return !(a < b); }
+};
+
 // Динамическая матрица - 
 // шаблонная матрица на динамической памяти
 template<typename T>
@@ -127,47 +964,583 @@ class TDynamicMatrix : private TDynamicVector<TDynamicVector<T>>
 {
   using TDynamicVector<TDynamicVector<T>>::pMem;
   using TDynamicVector<TDynamicVector<T>>::sz;
+
+  // Строки выделяются и заполняются init(p, i) параллельно с тем же
+  // статическим разбиением строк по потокам, что и в вычислительных
+  // ядрах, поэтому при первом касании страницы попадают на узел NUMA
+  // своего потока
+  template<typename Init>
+  void CreateRows(TNumaPolicy policy, Init init)
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_CREATE, sz, sz * sz, 0, sz * sz * sizeof(T), sz + 1);
+    if (sz > MAX_MATRIX_SIZE)
+      throw out_of_range("Matrix size should be less than MAX_MATRIX_SIZE");
+    exception_ptr err;
+    const int n = (int)sz;
+    #pragma omp parallel if (sz >= MATRIX_PARALLEL_SIZE)
+    {
+      TMATRIX_CHUNK_SCOPE("create rows", sz);
+      #pragma omp for schedule(static) nowait
+      for (int i = 0; i < n; i++)
+      {
+        try
+        {
+          TDynamicVector<T>& r = pMem[i];
+          T* p = AllocArray<T>(sz);
+          r.pMem = p;
+          r.sz = sz;
+          if (policy != NUMA_FIRST_TOUCH)
+            NumaPlace(p, sz * sizeof(T), policy == NUMA_INTERLEAVE ? -1 : NumaPartitionNode(i, sz));
+          init(p, (size_t)i);
+        }
+        catch (...)
+        {
+          #pragma omp critical
+          err = current_exception();
+        }
+      }
+    }
+    if (err)
+      rethrow_exception(err);
+  }
+  // dst[i][j] = op(dst[i][j], src[i][j]) на месте, по строкам параллельно
+  template<typename Op>
+  static void Combine(TDynamicMatrix& dst, const TDynamicMatrix& src, Op op)
+  {
+    const int n = (int)dst.sz;
+    #pragma omp parallel if (dst.sz >= MATRIX_PARALLEL_SIZE)
+    {
+      TMATRIX_CHUNK_SCOPE("combine rows", dst.sz);
+      #pragma omp for schedule(static) nowait
+      for (int i = 0; i < n; i++)
+      {
+        T* d = dst.pMem[i].pMem;
+        const T* s = src.pMem[i].pMem;
+        for (int j = 0; j < n; j++)
+          d[j] = op(d[j], s[j]);
+      }
+    }
+  }
 public:
-  TDynamicMatrix(size_t s = 1) : TDynamicVector<TDynamicVector<T>>(s)
+  TDynamicMatrix(size_t s = 1, TNumaPolicy policy = NUMA_FIRST_TOUCH) : TDynamicVector<TDynamicVector<T>>(s, TRowArrayTag())
+  {
+    const size_t n = sz;
+    CreateRows(policy, [n](T* p, size_t) { std::fill(p, p + n, T()); });
+  }
+  TDynamicMatrix(size_t s, TUninitTag, TNumaPolicy policy = NUMA_FIRST_TOUCH) : TDynamicVector<TDynamicVector<T>>(s, TRowArrayTag())
+  {
+    CreateRows(policy, [](T*, size_t) {});
+  }
+  TDynamicMatrix(size_t s, TFillTag, const T& val, TNumaPolicy policy = NUMA_FIRST_TOUCH) : TDynamicVector<TDynamicVector<T>>(s, TRowArrayTag())
   {
+    const size_t n = sz;
+    CreateRows(policy, [n, &val](T* p, size_t) { std::fill(p, p + n, val); });
+  }
+  // Представление матрицы s x s, лежащей в data по строкам с шагом ld
+  // (по умолчанию s), без копирования: строки - представления (VIEW)
+  TDynamicMatrix(T* data, size_t s, TViewTag, size_t ld = 0) : TDynamicVector<TDynamicVector<T>>(s, TRowArrayTag())
+  {
+    if (sz > MAX_MATRIX_SIZE)
+      throw out_of_range("Matrix size should be less than MAX_MATRIX_SIZE");
+    if (ld == 0)
+      ld = sz;
+    if (ld < sz)
+      throw invalid_argument("Matrix row stride should not be less than matrix size");
     for (size_t i = 0; i < sz; i++)
-      pMem[i] = TDynamicVector<T>(sz);
+      pMem[i] = TDynamicVector<T>(data + i * ld, sz, VIEW);
+  }
+#ifdef __cpp_lib_mdspan
+  TDynamicMatrix(std::mdspan<T, std::dextents<size_t, 2>> m, TViewTag) : TDynamicMatrix(m.data_handle(), m.extent(0), VIEW)
+  {
+    if (m.extent(0) != m.extent(1))
+      throw length_error("Matrix view requires a square mdspan");
   }
+#endif
+  // m[i][j] = gen(i, j), строки заполняются параллельно
+  template<typename Gen>
+  TDynamicMatrix(size_t s, TGenerateTag, Gen gen, TNumaPolicy policy = NUMA_FIRST_TOUCH) : TDynamicVector<TDynamicVector<T>>(s, TRowArrayTag())
+  {
+    const size_t n = sz;
+    CreateRows(policy, [n, &gen](T* p, size_t i)
+    {
+      for (size_t j = 0; j < n; j++)
+        p[j] = gen(i, j);
+    });
+  }
+  // копия (в том числе представления) владеет своей памятью, строки
+  // копируются параллельно
+  TDynamicMatrix(const TDynamicMatrix& m) : TDynamicVector<TDynamicVector<T>>(m.sz, TRowArrayTag())
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_COPY, sz, sz * sz, 0, 2 * sz * sz * sizeof(T), 0);
+    const TDynamicVector<T>* src = m.pMem;
+    const size_t n = sz;
+    CreateRows(NUMA_FIRST_TOUCH, [src, n](T* p, size_t i) { std::copy(src[i].pMem, src[i].pMem + n, p); });
+  }
+  TDynamicMatrix(TDynamicMatrix&& m) noexcept = default;
+  // при равных размерах элементы копируются в имеющиеся строки
+  // (у представления - во внешний буфер)
+  TDynamicMatrix& operator=(const TDynamicMatrix& m)
+  {
+    if (this == &m)
+      return *this;
+    if (sz != m.sz)
+    {
+      TDynamicMatrix tmp(m);
+      swap(*this, tmp);
+      return *this;
+    }
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_COPY, sz, sz * sz, 0, 2 * sz * sz * sizeof(T), 0);
+    const int n = (int)sz;
+    #pragma omp parallel if (sz >= MATRIX_PARALLEL_SIZE)
+    {
+      TMATRIX_CHUNK_SCOPE("copy rows", sz);
+      #pragma omp for schedule(static) nowait
+      for (int i = 0; i < n; i++)
+        std::copy(m.pMem[i].pMem, m.pMem[i].pMem + sz, pMem[i].pMem);
+    }
+    return *this;
+  }
+  TDynamicMatrix& operator=(TDynamicMatrix&& m) noexcept = default;
 
   using TDynamicVector<TDynamicVector<T>>::operator[];
+  using TDynamicVector<TDynamicVector<T>>::at;
+  using TDynamicVector<TDynamicVector<T>>::size;
+  // false для представления чужой памяти (VIEW)
+  bool owns() const noexcept { return pMem[0].owns(); }
+
+#ifdef __cpp_lib_mdspan
+  // std::mdspan над строками матрицы. Строки должны лежать в памяти
+  // с постоянным шагом, как у представления внешнего буфера; строки
+  // обычной матрицы выделяются отдельно, для нее бросается исключение
+  std::mdspan<T, std::dextents<size_t, 2>, std::layout_stride> as_mdspan()
+  {
+    const ptrdiff_t ld = sz > 1 ? pMem[1].pMem - pMem[0].pMem : (ptrdiff_t)sz;
+    if (ld < (ptrdiff_t)sz)
+      throw runtime_error("Matrix rows are not equally spaced");
+    for (size_t i = 2; i < sz; i++)
+      if (pMem[i].pMem != pMem[0].pMem + i * ld)
+        throw runtime_error("Matrix rows are not equally spaced");
+    std::layout_stride::mapping<std::dextents<size_t, 2>> map(std::dextents<size_t, 2>(sz, sz),
+      std::array<size_t, 2>{ (size_t)ld, 1 });
+    return std::mdspan<T, std::dextents<size_t, 2>, std::layout_stride>(pMem[0].pMem, map);
+  }
+#endif
+
+  // итераторы по строкам (begin, end) и по всем элементам в порядке
+  // строк (element_begin, element_end)
+  typedef TMatrixElementIterator<T, TDynamicVector<T>> element_iterator;
+  typedef TMatrixElementIterator<const T, const TDynamicVector<T>> const_element_iterator;
+  using typename TDynamicVector<TDynamicVector<T>>::iterator;
+  using typename TDynamicVector<TDynamicVector<T>>::const_iterator;
+  using TDynamicVector<TDynamicVector<T>>::begin;
+  using TDynamicVector<TDynamicVector<T>>::end;
+  using TDynamicVector<TDynamicVector<T>>::cbegin;
+  using TDynamicVector<TDynamicVector<T>>::cend;
+
+  element_iterator element_begin() noexcept { return element_iterator(pMem, sz, 0); }
+  element_iterator element_end() noexcept { return element_iterator(pMem, sz, sz * sz); }
+  const_element_iterator element_begin() const noexcept { return const_element_iterator(pMem, sz, 0); }
+  const_element_iterator element_end() const noexcept { return const_element_iterator(pMem, sz, sz * sz); }
 
   // сравнение
   bool operator==(const TDynamicMatrix& m) const noexcept
   {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_COMPARE, sz, sz * sz, 0, 2 * sz * sz * sizeof(T), 0);
+    if (sz != m.sz)
+      return false;
+    const TDynamicVector<T>* a = pMem;
+    const TDynamicVector<T>* b = m.pMem;
+    return AllBlocks(sz, 1, [a, b](size_t i, size_t) { return a[i] == b[i]; }, sz);
+  }
+  bool operator!=(const TDynamicMatrix& m) const noexcept
+  {
+    return !(*this == m);
+  }
+  bool approx_equal(const TDynamicMatrix& m, T abs_tol, T rel_tol = T(), unsigned long long ulps = 0) const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_COMPARE, sz, sz * sz, 3 * sz * sz, 2 * sz * sz * sizeof(T), 0);
+    if (sz != m.sz)
+      return false;
+    const TDynamicVector<T>* a = pMem;
+    const TDynamicVector<T>* b = m.pMem;
+    return AllBlocks(sz, 1, [=](size_t i, size_t) { return a[i].approx_equal(b[i], abs_tol, rel_tol, ulps); }, sz);
   }
 
   // матрично-скалярные операции
-  TDynamicMatrix operator*(const T& val)
+  TDynamicMatrix operator*(const T& val) const &
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_SCALAR, sz, sz * sz, sz * sz, 2 * sz * sz * sizeof(T), 0);
+    const TDynamicVector<T>* a = pMem;
+    return TDynamicMatrix(sz, GENERATE, [a, &val](size_t i, size_t j) { return a[i].pMem[j] * val; });
+  }
+  TDynamicMatrix operator*(const T& val) &&
   {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_SCALAR, sz, sz * sz, sz * sz, 2 * sz * sz * sizeof(T), 0);
+    if (!owns())
+      return static_cast<const TDynamicMatrix&>(*this) * val;
+    Combine(*this, *this, [&val](const T& x, const T&) { return x * val; });
+    return std::move(*this);
   }
 
   // матрично-векторные операции
-  TDynamicVector<T> operator*(const TDynamicVector<T>& v)
+  TDynamicVector<T> operator*(const TDynamicVector<T>& v) const
   {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_VECTOR, sz, sz * sz, 2 * sz * sz, (sz * sz + 2 * sz) * sizeof(T), 1);
+    if (sz != v.sz)
+      throw length_error("Matrix and vector sizes should be equal");
+    TDynamicVector<T> res(sz, UNINITIALIZED);
+    const TDynamicVector<T>* a = pMem;
+    if (SystemGemv<T>(sz, [a](size_t i) { return a[i].pMem; }, v.pMem, res.pMem))
+      return res;
+    for (size_t i = 0; i < sz; i++)
+      res.pMem[i] = pMem[i] * v;
+    return res;
   }
 
   // матрично-матричные операции
-  TDynamicMatrix operator+(const TDynamicMatrix& m)
+  TDynamicMatrix operator+(const TDynamicMatrix& m) const &
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_ADD, sz, sz * sz, sz * sz, 3 * sz * sz * sizeof(T), 0);
+    if (sz != m.sz)
+      throw length_error("Matrix sizes should be equal");
+    const TDynamicVector<T>* a = pMem;
+    const TDynamicVector<T>* b = m.pMem;
+    return TDynamicMatrix(sz, GENERATE, [a, b](size_t i, size_t j) { return a[i].pMem[j] + b[i].pMem[j]; });
+  }
+  TDynamicMatrix operator+(const TDynamicMatrix& m) &&
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_ADD, sz, sz * sz, sz * sz, 3 * sz * sz * sizeof(T), 0);
+    if (!owns())
+      return static_cast<const TDynamicMatrix&>(*this) + m;
+    if (sz != m.sz)
+      throw length_error("Matrix sizes should be equal");
+    Combine(*this, m, [](const T& x, const T& y) { return x + y; });
+    return std::move(*this);
+  }
+  TDynamicMatrix operator+(TDynamicMatrix&& m) const &
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_ADD, sz, sz * sz, sz * sz, 3 * sz * sz * sizeof(T), 0);
+    if (!m.owns())
+      return *this + static_cast<const TDynamicMatrix&>(m);
+    if (sz != m.sz)
+      throw length_error("Matrix sizes should be equal");
+    Combine(m, *this, [](const T& y, const T& x) { return x + y; });
+    return std::move(m);
+  }
+  TDynamicMatrix operator+(TDynamicMatrix&& m) &&
+  {
+    return std::move(*this) + static_cast<const TDynamicMatrix&>(m);
+  }
+  TDynamicMatrix operator-(const TDynamicMatrix& m) const &
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_SUB, sz, sz * sz, sz * sz, 3 * sz * sz * sizeof(T), 0);
+    if (sz != m.sz)
+      throw length_error("Matrix sizes should be equal");
+    const TDynamicVector<T>* a = pMem;
+    const TDynamicVector<T>* b = m.pMem;
+    return TDynamicMatrix(sz, GENERATE, [a, b](size_t i, size_t j) { return a[i].pMem[j] - b[i].pMem[j]; });
+  }
+  TDynamicMatrix operator-(const TDynamicMatrix& m) &&
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_SUB, sz, sz * sz, sz * sz, 3 * sz * sz * sizeof(T), 0);
+    if (!owns())
+      return static_cast<const TDynamicMatrix&>(*this) - m;
+    if (sz != m.sz)
+      throw length_error("Matrix sizes should be equal");
+    Combine(*this, m, [](const T& x, const T& y) { return x - y; });
+    return std::move(*this);
+  }
+  TDynamicMatrix operator-(TDynamicMatrix&& m) const &
   {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_SUB, sz, sz * sz, sz * sz, 3 * sz * sz * sizeof(T), 0);
+    if (!m.owns())
+      return *this - static_cast<const TDynamicMatrix&>(m);
+    if (sz != m.sz)
+      throw length_error("Matrix sizes should be equal");
+    Combine(m, *this, [](const T& y, const T& x) { return x - y; });
+    return std::move(m);
   }
-  TDynamicMatrix operator-(const TDynamicMatrix& m)
+  TDynamicMatrix operator-(TDynamicMatrix&& m) &&
   {
+    return std::move(*this) - static_cast<const TDynamicMatrix&>(m);
   }
-  TDynamicMatrix operator*(const TDynamicMatrix& m)
+  TDynamicMatrix operator*(const TDynamicMatrix& m) const
   {
+    return Multiply<TPlusTimes<T>>(m);
+  }
+
+  // произведение над полукольцом S (см. TPlusTimes, TMinPlus, TMaxMin),
+  // строки результата вычисляются параллельно. Обычное произведение
+  // float и double выполняет системная BLAS, если она выбрана (tblas.h)
+  template<typename S>
+  TDynamicMatrix Multiply(const TDynamicMatrix& m) const
+  {
+    TDynamicMatrix res(sz, UNINITIALIZED);
+    MultiplyInto<S>(m, res);
+    return res;
+  }
+  // то же в готовый буфер res того же размера, без выделения памяти под
+  // результат; res не должен совпадать с операндами
+  template<typename S>
+  void MultiplyInto(const TDynamicMatrix& m, TDynamicMatrix& res) const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_MULTIPLY, sz, sz * sz, 2 * sz * sz * sz, 3 * sz * sz * sizeof(T), 0);
+    if (sz != m.sz || sz != res.sz)
+      throw length_error("Matrix sizes should be equal");
+    if (&res == this || &res == &m)
+      throw invalid_argument("Result matrix should differ from operands");
+    if (std::is_same<S, TPlusTimes<T>>::value)
+    {
+      const TDynamicVector<T>* a = pMem;
+      const TDynamicVector<T>* b = m.pMem;
+      const TDynamicVector<T>* c = res.pMem;
+      if (SystemGemm<T>(sz, [a](size_t i) { return a[i].pMem; }, [b](size_t i) { return b[i].pMem; },
+        [c](size_t i) { return c[i].pMem; }))
+        return;
+    }
+    typedef typename S::acc_type A;
+    const bool direct = std::is_same<A, T>::value;
+    // блоки ib строк результата проходят панель m размером kb x jb, пока
+    // она в кэше (ttune.h); слагаемые каждого элемента по-прежнему
+    // складываются по возрастанию k
+    const TTuning& tuning = Tuning();
+    const size_t ib = tuning.multiply_rows;
+    const size_t kb = tuning.multiply_depth == 0 ? sz : tuning.multiply_depth;
+    const size_t jb = tuning.multiply_cols == 0 ? sz : tuning.multiply_cols;
+    const int nblocks = (int)((sz + ib - 1) / ib);
+    #pragma omp parallel if (sz >= MATRIX_PARALLEL_SIZE)
+    {
+      TMATRIX_CHUNK_SCOPE("multiply rows", nblocks);
+      // если T накапливается в более широком типе, строки считаются в буфере
+      A* buf = direct ? nullptr : new A[std::min(ib, sz) * sz];
+      #pragma omp for schedule(static) nowait
+      for (int b = 0; b < nblocks; b++)
+      {
+        const size_t i0 = b * ib, i1 = std::min(sz, i0 + ib);
+        auto acc = [&](size_t i) { return direct ? reinterpret_cast<A*>(res.pMem[i].pMem) : buf + (i - i0) * sz; };
+        for (size_t i = i0; i < i1; i++)
+          std::fill(acc(i), acc(i) + sz, S::zero());
+        for (size_t j0 = 0; j0 < sz; j0 += jb)
+        {
+          const size_t j1 = std::min(sz, j0 + jb);
+          for (size_t k0 = 0; k0 < sz; k0 += kb)
+          {
+            const size_t k1 = std::min(sz, k0 + kb);
+            for (size_t i = i0; i < i1; i++)
+            {
+              A* c = acc(i);
+              const T* ai = pMem[i].pMem;
+              for (size_t k = k0; k < k1; k++)
+              {
+                const A a = A(ai[k]);
+                const T* bk = m.pMem[k].pMem;
+                for (size_t j = j0; j < j1; j++)
+                  c[j] = S::add(c[j], S::mul(a, A(bk[j])));
+              }
+            }
+          }
+        }
+        if (!direct)
+          for (size_t i = i0; i < i1; i++)
+          {
+            T* r = res.pMem[i].pMem;
+            const A* c = acc(i);
+            for (size_t j = 0; j < sz; j++)
+              r[j] = T(c[j]);
+          }
+      }
+      delete[] buf;
+    }
+  }
+
+  // транспонирование квадратными блоками Tuning().transpose_block
+  TDynamicMatrix transpose() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_TRANSPOSE, sz, sz * sz, 0, 2 * sz * sz * sizeof(T), 0);
+    TDynamicMatrix res(sz, UNINITIALIZED);
+    const size_t tb = Tuning().transpose_block;
+    const int nblocks = (int)((sz + tb - 1) / tb);
+    #pragma omp parallel if (sz >= MATRIX_PARALLEL_SIZE)
+    {
+      TMATRIX_CHUNK_SCOPE("transpose blocks", nblocks);
+      // поток заполняет блок строк результата (столбцов исходной матрицы)
+      #pragma omp for schedule(static) nowait
+      for (int b = 0; b < nblocks; b++)
+      {
+        const size_t j0 = b * tb, j1 = std::min(sz, j0 + tb);
+        for (size_t i0 = 0; i0 < sz; i0 += tb)
+        {
+          const size_t i1 = std::min(sz, i0 + tb);
+          for (size_t i = i0; i < i1; i++)
+          {
+            const T* a = pMem[i].pMem;
+            for (size_t j = j0; j < j1; j++)
+              res.pMem[j].pMem[i] = a[j];
+          }
+        }
+      }
+    }
+    return res;
+  }
+
+  // редукции по всем элементам: строка - лист, строки объединяются
+  // попарным деревом, поэтому результат не зависит от числа потоков
+  template<typename R, typename RowFn, typename Combine>
+  R ReduceRows(RowFn rowfn, Combine comb) const
+  {
+    R* part = new R[sz];
+    const int n = (int)sz;
+    #pragma omp parallel if (sz >= MATRIX_PARALLEL_SIZE)
+    {
+      TMATRIX_CHUNK_SCOPE("reduce rows", sz);
+      #pragma omp for nowait
+      for (int i = 0; i < n; i++)
+        part[i] = rowfn(pMem[i]);
+    }
+    R res = PairwiseReduce(part, sz, comb);
+    delete[] part;
+    return res;
+  }
+
+  T trace() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_REDUCE, sz, sz, sz, sz * sizeof(T), 0);
+    typedef typename TAccumulator<T>::type A;
+    A res = A();
+    for (size_t i = 0; i < sz; i++)
+      res += A(pMem[i].pMem[i]);
+    return T(res);
+  }
+  T sum() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_REDUCE, sz, sz * sz, sz * sz, sz * sz * sizeof(T), 0);
+    typedef typename TAccumulator<T>::type A;
+    return T(ReduceRows<A>(
+      [](const TDynamicVector<T>& r)
+      {
+        const T* a = r.pMem;
+        return LeafSum<A>(0, r.sz, [a](size_t i) { return A(a[i]); });
+      },
+      [](const A& x, const A& y) { return x + y; }));
+  }
+  T min() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_REDUCE, sz, sz * sz, sz * sz, sz * sz * sizeof(T), 0);
+    return ReduceRows<T>([](const TDynamicVector<T>& r) { return *std::min_element(r.pMem, r.pMem + r.sz); },
+      [](const T& x, const T& y) { return y < x ? y : x; });
+  }
+  T max() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_REDUCE, sz, sz * sz, sz * sz, sz * sz * sizeof(T), 0);
+    return ReduceRows<T>([](const TDynamicVector<T>& r) { return *std::max_element(r.pMem, r.pMem + r.sz); },
+      [](const T& x, const T& y) { return x < y ? y : x; });
+  }
+  // позиция (строка, столбец) первого наибольшего/наименьшего элемента
+  pair<size_t, size_t> argmax() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_REDUCE, sz, sz * sz, sz * sz, sz * sz * sizeof(T), 0);
+    const TDynamicVector<T>* rows = pMem;
+    size_t flat = ReduceRows<size_t>(
+      [rows](const TDynamicVector<T>& r) { return (&r - rows) * r.sz + (std::max_element(r.pMem, r.pMem + r.sz) - r.pMem); },
+      [rows](size_t x, size_t y)
+      {
+        size_t n = rows[0].sz;
+        return rows[x / n].pMem[x % n] < rows[y / n].pMem[y % n] ? y : x;
+      });
+    return make_pair(flat / sz, flat % sz);
+  }
+  pair<size_t, size_t> argmin() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_REDUCE, sz, sz * sz, sz * sz, sz * sz * sizeof(T), 0);
+    const TDynamicVector<T>* rows = pMem;
+    size_t flat = ReduceRows<size_t>(
+      [rows](const TDynamicVector<T>& r) { return (&r - rows) * r.sz + (std::min_element(r.pMem, r.pMem + r.sz) - r.pMem); },
+      [rows](size_t x, size_t y)
+      {
+        size_t n = rows[0].sz;
+        return rows[y / n].pMem[y % n] < rows[x / n].pMem[x % n] ? y : x;
+      });
+    return make_pair(flat / sz, flat % sz);
+  }
+
+  // нормы: Фробениуса, максимум сумм модулей по столбцам и по строкам
+  T norm_frobenius() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_REDUCE, sz, sz * sz, sz * sz, sz * sz * sizeof(T), 0);
+    typedef typename TAccumulator<T>::type A;
+    A sq = ReduceRows<A>(
+      [](const TDynamicVector<T>& r)
+      {
+        const T* a = r.pMem;
+        return LeafSum<A>(0, r.sz, [a](size_t i) { return A(a[i]) * A(a[i]); });
+      },
+      [](const A& x, const A& y) { return x + y; });
+    return T(std::sqrt(sq));
+  }
+  T norm1() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_REDUCE, sz, sz * sz, sz * sz, sz * sz * sizeof(T), 0);
+    typedef typename TAccumulator<T>::type A;
+    // суммы по столбцам накапливаются блоками строк фиксированной высоты
+    const size_t rows = MATRIX_PARALLEL_SIZE;
+    const size_t nb = (sz + rows - 1) / rows;
+    A* part = new A[nb * sz];
+    const int nblocks = (int)nb;
+    #pragma omp parallel if (nb > 1)
+    {
+      TMATRIX_CHUNK_SCOPE("column sum blocks", nb);
+      #pragma omp for nowait
+      for (int b = 0; b < nblocks; b++)
+      {
+        A* col = part + b * sz;
+        std::fill(col, col + sz, A());
+        for (size_t i = b * rows; i < std::min(sz, (b + 1) * rows); i++)
+        {
+          const T* a = pMem[i].pMem;
+          for (size_t j = 0; j < sz; j++)
+            col[j] += AbsValue(A(a[j]));
+        }
+      }
+    }
+    for (size_t step = 1; step < nb; step *= 2)
+      for (size_t b = 0; b + step < nb; b += 2 * step)
+      {
+        A* dst = part + b * sz;
+        const A* src = part + (b + step) * sz;
+        for (size_t j = 0; j < sz; j++)
+          dst[j] += src[j];
+      }
+    A res = *std::max_element(part, part + sz);
+    delete[] part;
+    return T(res);
+  }
+  T norm_inf() const
+  {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_REDUCE, sz, sz * sz, sz * sz, sz * sz * sizeof(T), 0);
+    return ReduceRows<T>([](const TDynamicVector<T>& r) { return r.norm1(); },
+      [](const T& x, const T& y) { return x < y ? y : x; });
+  }
+
+  friend void swap(TDynamicMatrix& lhs, TDynamicMatrix& rhs) noexcept
+  {
+    swap(static_cast<TDynamicVector<TDynamicVector<T>>&>(lhs),
+      static_cast<TDynamicVector<TDynamicVector<T>>&>(rhs));
   }
 
   // ввод/вывод
   friend istream& operator>>(istream& istr, TDynamicMatrix& v)
   {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_IO, v.sz, v.sz * v.sz, 0, v.sz * v.sz * sizeof(T), 0);
+    for (size_t i = 0; i < v.sz; i++)
+      istr >> v.pMem[i];
+    return istr;
   }
   friend ostream& operator<<(ostream& ostr, const TDynamicMatrix& v)
   {
+    TMATRIX_PROFILE_SCOPE(PROF_MATRIX_IO, v.sz, v.sz * v.sz, 0, v.sz * v.sz * sizeof(T), 0);
+    for (size_t i = 0; i < v.sz; i++)
+      ostr << v.pMem[i] << endl;
+    return ostr;
   }
 };
 
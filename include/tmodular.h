@@ -0,0 +1,143 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Вычеты по простому модулю P в форме Монтгомери (R = 2^32)
+//
+//
+
+#ifndef __TModular_H__
+#define __TModular_H__
+
+#include <cstdint>
+#include "tmatrix.h"
+
+template<uint32_t P> class TModAccum;
+
+// Элемент Z/P, хранится значение a * R mod P.
+// Умножение выполняется редукцией Монтгомери без деления
+template<uint32_t P>
+class TModInt
+{
+  static_assert(P % 2 == 1 && P < (1u << 30), "Modulus should be odd and less than 2^30");
+
+  friend class TModAccum<P>;
+protected:
+  uint32_t v;
+
+  // -P^-1 mod 2^32 (итерации Ньютона)
+  static constexpr uint32_t Inverse(uint32_t x, int k)
+  {
+    return k == 0 ? x : Inverse(x * (2 - P * x), k - 1);
+  }
+  static constexpr uint32_t NegInv = 0u - Inverse(P, 5);
+  // R^2 mod P
+  static constexpr uint32_t R2 = uint32_t(((uint64_t(1) << 32) % P) * ((uint64_t(1) << 32) % P) % P);
+
+public:
+  // x * R^-1 mod P для x < P * 2^32
+  static uint32_t Reduce(uint64_t x)
+  {
+    uint32_t m = uint32_t(x) * NegInv;
+    uint32_t t = uint32_t((x + uint64_t(m) * P) >> 32);
+    return t >= P ? t - P : t;
+  }
+
+  TModInt() : v(0) {}
+  TModInt(long long x)
+  {
+    long long r = x % (long long)P;
+    if (r < 0)
+      r += P;
+    v = Reduce(uint64_t(r) * R2);
+  }
+  TModInt(const TModAccum<P>& a) : v(Reduce(a.s)) {}
+
+  static constexpr uint32_t modulus() { return P; }
+  uint32_t value() const { return Reduce(v); }
+
+  TModInt& operator+=(const TModInt& b)
+  {
+    v += b.v;
+    v = v >= P ? v - P : v;
+    return *this;
+  }
+  TModInt& operator-=(const TModInt& b)
+  {
+    v = v >= b.v ? v - b.v : v + P - b.v;
+    return *this;
+  }
+  TModInt& operator*=(const TModInt& b)
+  {
+    v = Reduce(uint64_t(v) * b.v);
+    return *this;
+  }
+  friend TModInt operator+(TModInt a, const TModInt& b) { return a += b; }
+  friend TModInt operator-(TModInt a, const TModInt& b) { return a -= b; }
+  friend TModInt operator*(TModInt a, const TModInt& b) { return a *= b; }
+  TModInt operator-() const { return TModInt() - *this; }
+
+  // обратный элемент по малой теореме Ферма
+  TModInt inverse() const
+  {
+    TModInt res(1), a(*this);
+    for (uint32_t e = P - 2; e; e >>= 1)
+    {
+      if (e & 1)
+        res *= a;
+      a *= a;
+    }
+    return res;
+  }
+
+  bool operator==(const TModInt& b) const { return v == b.v; }
+  bool operator!=(const TModInt& b) const { return v != b.v; }
+  // порядок нужен для min/max, сравниваются канонические значения
+  bool operator<(const TModInt& b) const { return value() < b.value(); }
+
+  friend istream& operator>>(istream& istr, TModInt& a)
+  {
+    long long x;
+    if (istr >> x)
+      a = TModInt(x);
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TModInt& a)
+  {
+    return ostr << a.value();
+  }
+};
+
+// Накопитель сумм произведений с отложенной редукцией.
+// Хранит представителя a * R^2 в диапазоне [0, P * 2^32): элемент
+// переводится сдвигом, произведение двух элементов дает vA * vB без
+// редукции, при сложении вычитается P * 2^32 (одно сравнение, без деления).
+// Редукция Монтгомери выполняется один раз при переводе обратно в TModInt
+template<uint32_t P>
+class TModAccum
+{
+  friend class TModInt<P>;
+protected:
+  static const uint64_t L = uint64_t(P) << 32;
+  uint64_t s;
+public:
+  TModAccum() : s(0) {}
+  TModAccum(const TModInt<P>& a) : s(uint64_t(a.v) << 32) {}
+
+  TModAccum& operator+=(const TModAccum& b)
+  {
+    s += b.s;
+    s = s >= L ? s - L : s;
+    return *this;
+  }
+  friend TModAccum operator+(TModAccum a, const TModAccum& b) { return a += b; }
+  // определено только для значений, полученных непосредственно из TModInt
+  friend TModAccum operator*(const TModAccum& a, const TModAccum& b)
+  {
+    TModAccum r;
+    r.s = (a.s >> 32) * (b.s >> 32);
+    return r;
+  }
+};
+
+template<uint32_t P> struct TAccumulator<TModInt<P>> { typedef TModAccum<P> type; };
+
+#endif
@@ -0,0 +1,98 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Размещение памяти по узлам NUMA.
+// В Linux используется системный вызов mbind (без libnuma), на других
+// системах и при ошибке вызова политика не применяется
+//
+//
+
+#ifndef __TNuma_H__
+#define __TNuma_H__
+
+#include <cstddef>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+// Политика размещения строк матрицы:
+//  NUMA_FIRST_TOUCH - страницы попадают на узел потока, первым
+//    записавшего строку (строки обнуляются параллельно с тем же
+//    разбиением, что и в вычислительных ядрах);
+//  NUMA_INTERLEAVE - страницы каждой строки чередуются по всем узлам;
+//  NUMA_PARTITION - непрерывные блоки строк закрепляются за узлами
+enum TNumaPolicy { NUMA_FIRST_TOUCH, NUMA_INTERLEAVE, NUMA_PARTITION };
+
+const int NUMA_MAX_NODES = 64;
+
+inline int ReadNumaNodeCount()
+{
+  int count = 1;
+#if defined(__linux__)
+  FILE* f = std::fopen("/sys/devices/system/node/online", "r");
+  if (f)
+  {
+    // формат: "0" или "0-1" или "0,2-3"; берется наибольший номер
+    int a, last = 0;
+    char sep;
+    while (std::fscanf(f, "%d", &a) == 1)
+    {
+      last = a > last ? a : last;
+      if (std::fscanf(f, "%c", &sep) != 1)
+        break;
+    }
+    std::fclose(f);
+    count = last + 1 > NUMA_MAX_NODES ? NUMA_MAX_NODES : last + 1;
+  }
+#endif
+  return count;
+}
+
+// число узлов NUMA (1, если узнать не удалось); читается один раз,
+// в том числе при первом вызове из параллельного цикла
+inline int NumaNodeCount()
+{
+  static const int count = ReadNumaNodeCount();
+  return count;
+}
+
+// Применение политики к страницам, целиком лежащим в [p, p + bytes).
+// node < 0 - чередование по всем узлам, иначе привязка к узлу node.
+// Вызывается до первой записи в память
+inline bool NumaPlace(void* p, size_t bytes, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+  const int nodes = NumaNodeCount();
+  if (nodes <= 1)
+    return false;
+  const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t first = ((size_t)p + page - 1) / page * page;
+  size_t last = ((size_t)p + bytes) / page * page;
+  if (last <= first)
+    return false;
+  unsigned long mask = 0;
+  if (node < 0)
+    mask = nodes >= 64 ? ~0ul : (1ul << nodes) - 1;
+  else
+    mask = 1ul << (node % nodes);
+  const int MPOL_BIND_MODE = 2, MPOL_INTERLEAVE_MODE = 3;
+  long r = syscall(SYS_mbind, (void*)first, last - first, node < 0 ? MPOL_INTERLEAVE_MODE : MPOL_BIND_MODE,
+    &mask, (unsigned long)(sizeof(mask) * 8), 0u);
+  return r == 0;
+#else
+  (void)p;
+  (void)bytes;
+  (void)node;
+  return false;
+#endif
+}
+
+// узел для строки i из n при политике NUMA_PARTITION
+inline int NumaPartitionNode(size_t i, size_t n)
+{
+  return (int)(i * (size_t)NumaNodeCount() / n);
+}
+
+#endif
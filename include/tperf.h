@@ -0,0 +1,296 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Аппаратные счетчики производительности (Linux, perf_event_open):
+// такты, инструкции, промахи кэшей и TLB, страничные отказы.
+// Счетчики, которые нельзя открыть (другая ОС, виртуальная машина,
+// ограничение kernel.perf_event_paranoid), считаются недоступными и
+// не учитываются; остальные работают как обычно
+//
+//
+
+#ifndef __TPerf_H__
+#define __TPerf_H__
+
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum TPerfEvent
+{
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_CACHE_REFERENCES,
+  PERF_CACHE_MISSES, // последний уровень кэша
+  PERF_L1D_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_PAGE_FAULTS,
+  PERF_EVENT_COUNT
+};
+
+inline const char* PerfEventName(TPerfEvent e)
+{
+  static const char* names[PERF_EVENT_COUNT] = {
+    "cycles", "instructions", "cache-references", "cache-misses", "L1d-misses", "dTLB-misses", "page-faults"
+  };
+  return e < PERF_EVENT_COUNT ? names[e] : "unknown";
+}
+
+// Значения счетчиков с временами работы группы, нс; available - маска
+// открытых счетчиков
+struct TPerfSample
+{
+  unsigned long long value[PERF_EVENT_COUNT];
+  unsigned long long enabled, running;
+  unsigned available;
+};
+
+// Значения группы, прочитанные с PERF_FORMAT_GROUP и временами работы:
+// buf = { nr, time_enabled, time_running, value[0..nr) }, slot[k] -
+// событие k-го значения. Группа, которая не получила аппаратных
+// счетчиков (time_running == 0, например все заняты), недоступна
+inline TPerfSample PerfDecode(const unsigned long long* buf, const int* slot, int nopen)
+{
+  TPerfSample s;
+  std::memset(&s, 0, sizeof(s));
+  if (buf[2] == 0)
+    return s;
+  s.enabled = buf[1];
+  s.running = buf[2];
+  const int n = (int)buf[0] < nopen ? (int)buf[0] : nopen;
+  for (int k = 0; k < n; k++)
+  {
+    s.value[slot[k]] = buf[3 + k];
+    s.available |= 1u << slot[k];
+  }
+  return s;
+}
+
+// Прирост события e между замерами. При разделении счетчиков по времени
+// прирост масштабируется на отношение приростов time_enabled и
+// time_running (масштабировать каждое значение отдельно нельзя: разность
+// оценок может оказаться отрицательной)
+inline unsigned long long PerfDelta(const TPerfSample& start, const TPerfSample& end, int e)
+{
+  if (end.value[e] <= start.value[e] || end.running <= start.running)
+    return 0;
+  const unsigned long long d = end.value[e] - start.value[e];
+  const unsigned long long enabled = end.enabled - start.enabled, running = end.running - start.running;
+  if (running >= enabled)
+    return d;
+  return (unsigned long long)((double)d * enabled / running);
+}
+
+// Группа счетчиков текущего потока (считаются только события этого
+// потока в пользовательском режиме)
+class TPerfGroup
+{
+  int fd[PERF_EVENT_COUNT];
+  int leader;
+  int slot[PERF_EVENT_COUNT]; // порядок значений при чтении группы
+  int nopen;
+
+  TPerfGroup(const TPerfGroup&) = delete;
+  TPerfGroup& operator=(const TPerfGroup&) = delete;
+public:
+  TPerfGroup() : leader(-1), nopen(0)
+  {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+      fd[e] = -1;
+#if defined(__linux__) && defined(SYS_perf_event_open)
+    const unsigned long long cache_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const unsigned types[PERF_EVENT_COUNT] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+      PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_SOFTWARE };
+    const unsigned long long configs[PERF_EVENT_COUNT] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_CACHE_L1D | cache_miss,
+      PERF_COUNT_HW_CACHE_DTLB | cache_miss, PERF_COUNT_SW_PAGE_FAULTS };
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = types[e];
+      attr.config = configs[e];
+      attr.disabled = leader < 0 ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      int f = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+      if (f < 0)
+        continue;
+      if (leader < 0)
+        leader = f;
+      fd[e] = f;
+      slot[nopen++] = e;
+    }
+    if (leader >= 0)
+      ioctl(leader, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+  ~TPerfGroup()
+  {
+#if defined(__linux__)
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+      if (fd[e] >= 0)
+        close(fd[e]);
+#endif
+  }
+
+  // маска открытых счетчиков (бит e - событие e)
+  unsigned available() const
+  {
+    unsigned mask = 0;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++)
+      if (fd[e] >= 0)
+        mask |= 1u << e;
+    return mask;
+  }
+
+  TPerfSample read() const
+  {
+#if defined(__linux__)
+    unsigned long long buf[3 + PERF_EVENT_COUNT];
+    if (leader >= 0 && ::read(leader, buf, sizeof(buf)) >= (ssize_t)(3 * sizeof(buf[0])))
+      return PerfDecode(buf, slot, nopen);
+#endif
+    TPerfSample s;
+    std::memset(&s, 0, sizeof(s));
+    return s;
+  }
+};
+
+inline TPerfGroup& PerfThisThread()
+{
+  thread_local TPerfGroup group;
+  return group;
+}
+
+// считает ли хотя бы один счетчик в текущем потоке
+inline bool PerfAvailable()
+{
+  return PerfThisThread().read().available != 0;
+}
+
+// Накопленные значения по месту вызова. Производные показатели равны 0,
+// если нужные счетчики недоступны
+struct TPerfStats
+{
+  unsigned long long calls;
+  unsigned long long value[PERF_EVENT_COUNT];
+  unsigned available;
+
+  static double Ratio(unsigned long long a, unsigned long long b) { return b == 0 ? 0.0 : double(a) / double(b); }
+
+  double ipc() const { return Ratio(value[PERF_INSTRUCTIONS], value[PERF_CYCLES]); }
+  double cache_miss_rate() const { return Ratio(value[PERF_CACHE_MISSES], value[PERF_CACHE_REFERENCES]); }
+  // промахи на тысячу инструкций
+  double l1d_mpki() const { return 1000 * Ratio(value[PERF_L1D_MISSES], value[PERF_INSTRUCTIONS]); }
+  double llc_mpki() const { return 1000 * Ratio(value[PERF_CACHE_MISSES], value[PERF_INSTRUCTIONS]); }
+  double dtlb_mpki() const { return 1000 * Ratio(value[PERF_DTLB_MISSES], value[PERF_INSTRUCTIONS]); }
+};
+
+inline std::mutex& PerfMutex()
+{
+  static std::mutex m;
+  return m;
+}
+
+inline std::map<std::string, TPerfStats>& PerfSites()
+{
+  static std::map<std::string, TPerfStats> sites;
+  return sites;
+}
+
+inline void PerfAdd(const char* site, const TPerfSample& start, const TPerfSample& end)
+{
+  const unsigned mask = start.available & end.available;
+  std::lock_guard<std::mutex> lock(PerfMutex());
+  std::map<std::string, TPerfStats>::iterator it = PerfSites().find(site);
+  if (it == PerfSites().end())
+  {
+    TPerfStats zero;
+    std::memset(&zero, 0, sizeof(zero));
+    it = PerfSites().insert(std::make_pair(std::string(site), zero)).first;
+  }
+  TPerfStats& s = it->second;
+  s.calls++;
+  s.available |= mask;
+  for (int e = 0; e < PERF_EVENT_COUNT; e++)
+    if (mask & (1u << e))
+      s.value[e] += PerfDelta(start, end, e);
+}
+
+// значения для места вызова (нули, если оно не встречалось)
+inline TPerfStats PerfSiteStats(const char* site)
+{
+  std::lock_guard<std::mutex> lock(PerfMutex());
+  std::map<std::string, TPerfStats>::const_iterator it = PerfSites().find(site);
+  if (it != PerfSites().end())
+    return it->second;
+  TPerfStats zero;
+  std::memset(&zero, 0, sizeof(zero));
+  return zero;
+}
+
+inline void PerfReset()
+{
+  std::lock_guard<std::mutex> lock(PerfMutex());
+  PerfSites().clear();
+}
+
+inline void PerfReport(std::ostream& ostr)
+{
+  std::lock_guard<std::mutex> lock(PerfMutex());
+  const std::ios_base::fmtflags flags = ostr.flags();
+  const std::streamsize precision = ostr.precision();
+  ostr << std::left << std::setw(24) << "site" << std::right << std::setw(10) << "calls" << std::setw(16) << "cycles"
+    << std::setw(8) << "IPC" << std::setw(10) << "LLC miss" << std::setw(10) << "L1d MPKI" << std::setw(10) << "LLC MPKI"
+    << std::setw(10) << "dTLB MPKI" << std::setw(12) << "page faults" << '\n';
+  for (std::map<std::string, TPerfStats>::const_iterator it = PerfSites().begin(); it != PerfSites().end(); ++it)
+  {
+    const TPerfStats& s = it->second;
+    ostr << std::left << std::setw(24) << it->first << std::right << std::setw(10) << s.calls
+      << std::setw(16) << s.value[PERF_CYCLES] << std::fixed << std::setprecision(2)
+      << std::setw(8) << s.ipc() << std::setw(10) << s.cache_miss_rate() << std::setw(10) << s.l1d_mpki()
+      << std::setw(10) << s.llc_mpki() << std::setw(10) << s.dtlb_mpki() << std::setw(12) << s.value[PERF_PAGE_FAULTS] << '\n';
+  }
+  ostr.flags(flags);
+  ostr.precision(precision);
+}
+
+// Замер счетчиков текущего потока на время жизни объекта; site -
+// строковый литерал с именем места вызова
+class TPerfScope
+{
+  const char* site;
+  TPerfSample start;
+
+  TPerfScope(const TPerfScope&) = delete;
+  TPerfScope& operator=(const TPerfScope&) = delete;
+public:
+  explicit TPerfScope(const char* s) : site(s), start(PerfThisThread().read()) {}
+  ~TPerfScope()
+  {
+    if (start.available != 0)
+      PerfAdd(site, start, PerfThisThread().read());
+  }
+};
+
+// Место вызова в пользовательском коде, например вокруг c = a * b
+#ifdef TMATRIX_PERF
+#define TMATRIX_PERF_SITE(name) TPerfScope tmatrix_perf_site_(name)
+#else
+#define TMATRIX_PERF_SITE(name) ((void)0)
+#endif
+
+#endif
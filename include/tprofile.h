@@ -0,0 +1,232 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Счетчики операций над векторами и матрицами: число вызовов,
+// обработанных элементов, оценка числа операций и объема данных,
+// выделения памяти, время. Включаются сборкой с TMATRIX_PROFILE.
+// Те же точки замера дают события трассы при сборке с TMATRIX_TRACE
+// (см. ttrace.h) и аппаратные счетчики по операциям при сборке
+// с TMATRIX_PERF (см. tperf.h); без этих макросов точки замера
+// не компилируются
+//
+//
+
+#ifndef __TProfile_H__
+#define __TProfile_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#ifdef TMATRIX_TRACE
+#include "ttrace.h"
+#endif
+#ifdef TMATRIX_PERF
+#include "tperf.h"
+#endif
+
+enum TProfileOp
+{
+  PROF_VECTOR_COPY,
+  PROF_VECTOR_ADD,
+  PROF_VECTOR_SUB,
+  PROF_VECTOR_SCALAR,
+  PROF_VECTOR_DOT,
+  PROF_VECTOR_REDUCE,
+  PROF_VECTOR_COMPARE,
+  PROF_VECTOR_IO,
+  PROF_MATRIX_CREATE,
+  PROF_MATRIX_COPY,
+  PROF_MATRIX_ADD,
+  PROF_MATRIX_SUB,
+  PROF_MATRIX_SCALAR,
+  PROF_MATRIX_VECTOR,
+  PROF_MATRIX_MULTIPLY,
+  PROF_MATRIX_TRANSPOSE,
+  PROF_MATRIX_REDUCE,
+  PROF_MATRIX_COMPARE,
+  PROF_MATRIX_IO,
+  PROF_OP_COUNT
+};
+
+inline const char* ProfileOpName(TProfileOp op)
+{
+  static const char* names[PROF_OP_COUNT] = {
+    "vector copy", "vector+vector", "vector-vector", "vector scalar op", "vector dot",
+    "vector reduce", "vector compare", "vector io",
+    "matrix create", "matrix copy", "matrix+matrix", "matrix-matrix", "matrix scalar op", "matrix*vector",
+    "matrix*matrix", "matrix transpose", "matrix reduce", "matrix compare", "matrix io"
+  };
+  return op < PROF_OP_COUNT ? names[op] : "unknown";
+}
+
+// Значения счетчиков одной операции. Элементы, операции, байты и
+// выделения памяти - собственная работа операции (вложенные операции,
+// например создание результата матричной суммы, учитываются отдельно),
+// время включает вложенные операции
+struct TProfileStats
+{
+  unsigned long long calls;
+  unsigned long long elements;
+  unsigned long long flops;
+  unsigned long long bytes;
+  unsigned long long allocations;
+  unsigned long long nanoseconds;
+};
+
+struct TProfileCounters
+{
+  std::atomic<unsigned long long> calls, elements, flops, bytes, allocations, nanoseconds;
+};
+
+inline TProfileCounters* ProfileCounters()
+{
+  static TProfileCounters counters[PROF_OP_COUNT];
+  return counters;
+}
+
+inline bool ProfileEnabled()
+{
+#ifdef TMATRIX_PROFILE
+  return true;
+#else
+  return false;
+#endif
+}
+
+inline TProfileStats ProfileStats(TProfileOp op)
+{
+  const TProfileCounters& c = ProfileCounters()[op];
+  TProfileStats s = { c.calls.load(), c.elements.load(), c.flops.load(), c.bytes.load(),
+    c.allocations.load(), c.nanoseconds.load() };
+  return s;
+}
+
+inline void ProfileReset()
+{
+  for (int i = 0; i < PROF_OP_COUNT; i++)
+  {
+    TProfileCounters& c = ProfileCounters()[i];
+    c.calls = c.elements = c.flops = c.bytes = c.allocations = c.nanoseconds = 0;
+  }
+}
+
+// таблица по операциям, которые вызывались
+inline void ProfileReport(std::ostream& ostr)
+{
+  const std::ios_base::fmtflags flags = ostr.flags();
+  const std::streamsize precision = ostr.precision();
+  ostr << std::left << std::setw(18) << "operation" << std::right << std::setw(12) << "calls"
+    << std::setw(16) << "elements" << std::setw(16) << "flops" << std::setw(16) << "bytes"
+    << std::setw(10) << "allocs" << std::setw(14) << "time, ms" << '\n';
+  for (int i = 0; i < PROF_OP_COUNT; i++)
+  {
+    TProfileStats s = ProfileStats((TProfileOp)i);
+    if (s.calls == 0)
+      continue;
+    ostr << std::left << std::setw(18) << ProfileOpName((TProfileOp)i) << std::right << std::setw(12) << s.calls
+      << std::setw(16) << s.elements << std::setw(16) << s.flops << std::setw(16) << s.bytes
+      << std::setw(10) << s.allocations << std::setw(14) << std::fixed << std::setprecision(3)
+      << s.nanoseconds / 1e6 << '\n';
+  }
+  ostr.flags(flags);
+  ostr.precision(precision);
+}
+
+// Замер одной операции: счетчики увеличиваются и событие трассы
+// записывается при выходе из области; shape - размер операнда.
+// Аппаратные счетчики относятся к вызывающему потоку, работу потоков
+// параллельных циклов учитывают TChunkScope
+class TProfileScope
+{
+  TProfileOp op;
+  size_t shape;
+  unsigned long long elements, flops, bytes, allocations;
+  std::chrono::steady_clock::time_point start;
+#ifdef TMATRIX_PERF
+  TPerfScope perf;
+#endif
+
+  TProfileScope(const TProfileScope&) = delete;
+  TProfileScope& operator=(const TProfileScope&) = delete;
+public:
+  TProfileScope(TProfileOp o, size_t n, size_t e, size_t f, size_t b, size_t a) :
+    op(o), shape(n), elements(e), flops(f), bytes(b), allocations(a), start(std::chrono::steady_clock::now())
+#ifdef TMATRIX_PERF
+    , perf(ProfileOpName(o))
+#endif
+  {
+  }
+  ~TProfileScope()
+  {
+#if defined(TMATRIX_TRACE) || defined(TMATRIX_PROFILE)
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+#endif
+#ifdef TMATRIX_TRACE
+    if (TraceActive())
+      TraceRecord(ProfileOpName(op), "op", start, end, shape);
+#endif
+#ifdef TMATRIX_PROFILE
+    const long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    TProfileCounters& c = ProfileCounters()[op];
+    c.calls.fetch_add(1, std::memory_order_relaxed);
+    c.elements.fetch_add(elements, std::memory_order_relaxed);
+    c.flops.fetch_add(flops, std::memory_order_relaxed);
+    c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    c.allocations.fetch_add(allocations, std::memory_order_relaxed);
+    c.nanoseconds.fetch_add((unsigned long long)ns, std::memory_order_relaxed);
+#endif
+  }
+};
+
+// Часть параллельного цикла, выполненная одним потоком: событие трассы
+// и аппаратные счетчики потока под именем части (например, "multiply
+// rows" суммирует работу всех потоков в ядре умножения); n - число
+// итераций цикла, распределяемых между потоками
+class TChunkScope
+{
+#ifdef TMATRIX_TRACE
+  TTraceScope trace;
+#endif
+#ifdef TMATRIX_PERF
+  TPerfScope perf;
+#endif
+
+  TChunkScope(const TChunkScope&) = delete;
+  TChunkScope& operator=(const TChunkScope&) = delete;
+public:
+  TChunkScope(const char* name, size_t n)
+#if defined(TMATRIX_TRACE) && defined(TMATRIX_PERF)
+    : trace(name, "chunk", n), perf(name)
+#elif defined(TMATRIX_TRACE)
+    : trace(name, "chunk", n)
+#elif defined(TMATRIX_PERF)
+    : perf(name)
+#endif
+  {
+    (void)name;
+    (void)n;
+  }
+};
+
+// Точка замера до конца текущего блока: операция, размер операнда,
+// элементы, операции с плавающей точкой, байты, выделения памяти.
+// Без TMATRIX_PROFILE, TMATRIX_TRACE и TMATRIX_PERF аргументы
+// не вычисляются
+#if defined(TMATRIX_PROFILE) || defined(TMATRIX_TRACE) || defined(TMATRIX_PERF)
+#define TMATRIX_PROFILE_SCOPE(op, n, elements, flops, bytes, allocs) \
+  TProfileScope tmatrix_profile_scope_(op, n, elements, flops, bytes, allocs)
+#else
+#define TMATRIX_PROFILE_SCOPE(op, n, elements, flops, bytes, allocs) ((void)0)
+#endif
+
+// Часть параллельного цикла из n итераций: объявляется в начале
+// параллельной области перед "omp for nowait", чтобы время не включало
+// ожидание на барьере
+#if defined(TMATRIX_TRACE) || defined(TMATRIX_PERF)
+#define TMATRIX_CHUNK_SCOPE(name, n) TChunkScope tmatrix_chunk_scope_(name, n)
+#else
+#define TMATRIX_CHUNK_SCOPE(name, n) ((void)0)
+#endif
+
+#endif
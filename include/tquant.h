@@ -0,0 +1,186 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Квантованные 8-битные матрицы с масштабными множителями
+// и произведение с накоплением в int32
+//
+//
+
+#ifndef __TQuant_H__
+#define __TQuant_H__
+
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include "tmatrix.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Один масштаб на всю матрицу или по масштабу на строку
+enum TQuantScale { QUANT_PER_TENSOR, QUANT_PER_ROW };
+
+// Симметричное квантование: x = scale * q.
+// int8_t использует диапазон [-127, 127], uint8_t - [0, 255]
+// (для неотрицательных данных, отрицательные значения обнуляются)
+template<typename Q>
+class TQuantMatrix
+{
+protected:
+  size_t n;
+  TDynamicMatrix<Q> q;
+  TDynamicVector<float> scale;
+public:
+  TQuantMatrix(size_t s = 1) : n(s), q(s), scale(s)
+  {
+    for (size_t i = 0; i < n; i++)
+      scale[i] = 1.0f;
+  }
+
+  size_t size() const noexcept { return n; }
+  TDynamicVector<Q>& operator[](size_t i) { return q[i]; }
+  const TDynamicVector<Q>& operator[](size_t i) const { return q[i]; }
+  float& row_scale(size_t i) { return scale[i]; }
+  float row_scale(size_t i) const { return scale[i]; }
+
+  static TQuantMatrix Quantize(const TDynamicMatrix<float>& m, TQuantScale mode = QUANT_PER_ROW)
+  {
+    const float qmax = (float)std::numeric_limits<Q>::max();
+    const float qmin = std::numeric_limits<Q>::is_signed ? -qmax : 0.0f;
+    TQuantMatrix res(m.size());
+    float tensor = 0.0f;
+    if (mode == QUANT_PER_TENSOR)
+      for (size_t i = 0; i < res.n; i++)
+        for (size_t j = 0; j < res.n; j++)
+          tensor = std::max(tensor, std::abs(m[i][j]));
+    for (size_t i = 0; i < res.n; i++)
+    {
+      float amax = tensor;
+      if (mode == QUANT_PER_ROW)
+        for (size_t j = 0; j < res.n; j++)
+          amax = std::max(amax, std::abs(m[i][j]));
+      float s = amax > 0.0f ? amax / qmax : 1.0f;
+      res.scale[i] = s;
+      for (size_t j = 0; j < res.n; j++)
+      {
+        float v = std::nearbyint(m[i][j] / s);
+        res.q[i][j] = (Q)std::min(qmax, std::max(qmin, v));
+      }
+    }
+    return res;
+  }
+
+  TDynamicMatrix<float> Dequantize() const
+  {
+    TDynamicMatrix<float> res(n);
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        res[i][j] = scale[i] * (float)q[i][j];
+    return res;
+  }
+};
+
+#if defined(__AVX2__)
+inline __m256i QuantWiden(const int8_t* p)
+{
+  return _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)p));
+}
+inline __m256i QuantWiden(const uint8_t* p)
+{
+  return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)p));
+}
+inline int32_t QuantHorizontalSum(__m256i v)
+{
+  __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+  return _mm_cvtsi128_si32(s);
+}
+#endif
+
+// Скалярное произведение 8-битных строк с накоплением в int32.
+// AVX2: расширение до int16 и vpmaddwd, 16 элементов за шаг
+template<typename Qa, typename Qb>
+int32_t QuantDot(const Qa* a, const Qb* b, size_t n)
+{
+  size_t k = 0;
+  int32_t res = 0;
+#if defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (; k + 16 <= n; k += 16)
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(QuantWiden(a + k), QuantWiden(b + k)));
+  res = QuantHorizontalSum(acc);
+#endif
+  for (; k < n; k++)
+    res += (int32_t)a[k] * (int32_t)b[k];
+  return res;
+}
+
+#if defined(__AVX2__) && (defined(__AVXVNNI__) || (defined(__AVX512VNNI__) && defined(__AVX512VL__)))
+// VNNI: vpdpbusd перемножает uint8 на int8 по четыре в каждой int32 ячейке
+template<>
+inline int32_t QuantDot<uint8_t, int8_t>(const uint8_t* a, const int8_t* b, size_t n)
+{
+  size_t k = 0;
+  __m256i acc = _mm256_setzero_si256();
+  for (; k + 32 <= n; k += 32)
+  {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + k));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + k));
+#if defined(__AVXVNNI__)
+    acc = _mm256_dpbusd_avx_epi32(acc, va, vb);
+#else
+    acc = _mm256_dpbusd_epi32(acc, va, vb);
+#endif
+  }
+  int32_t res = QuantHorizontalSum(acc);
+  for (; k < n; k++)
+    res += (int32_t)a[k] * (int32_t)b[k];
+  return res;
+}
+#endif
+
+// Накопители произведения A * B^T: c[i][j] = sum_k a[i][k] * b[j][k].
+// Строки B являются столбцами произведения (как у матрицы весов),
+// поэтому оба операнда читаются по строкам и масштабы строк выносятся
+template<typename Qa, typename Qb>
+TDynamicMatrix<int32_t> QuantAccumulate(const TQuantMatrix<Qa>& a, const TQuantMatrix<Qb>& b)
+{
+  const size_t n = a.size();
+  if (b.size() != n)
+    throw length_error("Matrix sizes should be equal");
+  TDynamicMatrix<int32_t> c(n, UNINITIALIZED);
+  const int nn = (int)n;
+  #pragma omp parallel for schedule(static) if (n >= MATRIX_PARALLEL_SIZE)
+  for (int i = 0; i < nn; i++)
+  {
+    const Qa* ai = &a[i][0];
+    int32_t* ci = &c[i][0];
+    for (size_t j = 0; j < n; j++)
+      ci[j] = QuantDot(ai, &b[j][0], n);
+  }
+  return c;
+}
+
+// A * B^T в вещественном виде: c[i][j] = sa[i] * sb[j] * acc[i][j]
+template<typename Qa, typename Qb>
+TDynamicMatrix<float> QuantMultiplyTransposed(const TQuantMatrix<Qa>& a, const TQuantMatrix<Qb>& b)
+{
+  TDynamicMatrix<int32_t> acc = QuantAccumulate(a, b);
+  const size_t n = a.size();
+  TDynamicMatrix<float> c(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      c[i][j] = a.row_scale(i) * b.row_scale(j) * (float)acc[i][j];
+  return c;
+}
+
+// A * B^T с повторным квантованием результата в тип Q
+template<typename Q, typename Qa, typename Qb>
+TQuantMatrix<Q> QuantMultiplyRequantize(const TQuantMatrix<Qa>& a, const TQuantMatrix<Qb>& b,
+  TQuantScale mode = QUANT_PER_ROW)
+{
+  return TQuantMatrix<Q>::Quantize(QuantMultiplyTransposed(a, b), mode);
+}
+
+#endif
@@ -0,0 +1,181 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Трасса выполнения операций в формате Chrome Trace Event (JSON),
+// открывается в chrome://tracing или Perfetto UI. Включается сборкой
+// с TMATRIX_TRACE, запись событий - между TraceStart и TraceStop
+//
+//
+
+#ifndef __TTrace_H__
+#define __TTrace_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Событие с длительностью; name и cat - строковые литералы,
+// n - размер операнда (0 - не указан)
+struct TTraceEvent
+{
+  const char* name;
+  const char* cat;
+  double ts, dur; // мкс от начала трассы
+  size_t n;
+};
+
+// События одного потока. Буферы потоков живут до конца программы,
+// поэтому запись не требует блокировок
+struct TTraceThread
+{
+  unsigned tid;
+  std::vector<TTraceEvent> events;
+};
+
+inline std::atomic<bool>& TraceActiveFlag()
+{
+  static std::atomic<bool> active(false);
+  return active;
+}
+
+inline bool TraceActive()
+{
+  return TraceActiveFlag().load(std::memory_order_relaxed);
+}
+
+inline std::chrono::steady_clock::time_point TraceEpoch()
+{
+  static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+  return epoch;
+}
+
+inline std::mutex& TraceMutex()
+{
+  static std::mutex m;
+  return m;
+}
+
+inline std::list<TTraceThread>& TraceThreads()
+{
+  static std::list<TTraceThread> threads;
+  return threads;
+}
+
+inline TTraceThread& TraceThisThread()
+{
+  thread_local TTraceThread* t = nullptr;
+  if (t == nullptr)
+  {
+    std::lock_guard<std::mutex> lock(TraceMutex());
+    std::list<TTraceThread>& threads = TraceThreads();
+    threads.push_back(TTraceThread());
+    threads.back().tid = (unsigned)threads.size();
+    t = &threads.back();
+  }
+  return *t;
+}
+
+inline void TraceStart()
+{
+  TraceEpoch();
+  TraceActiveFlag() = true;
+}
+
+inline void TraceStop()
+{
+  TraceActiveFlag() = false;
+}
+
+// TraceClear, TraceEventCount и TraceWrite вызываются, когда операции
+// не выполняются (например, после TraceStop)
+inline void TraceClear()
+{
+  std::lock_guard<std::mutex> lock(TraceMutex());
+  for (TTraceThread& t : TraceThreads())
+    t.events.clear();
+}
+
+inline size_t TraceEventCount()
+{
+  std::lock_guard<std::mutex> lock(TraceMutex());
+  size_t count = 0;
+  for (const TTraceThread& t : TraceThreads())
+    count += t.events.size();
+  return count;
+}
+
+inline void TraceRecord(const char* name, const char* cat, std::chrono::steady_clock::time_point start,
+  std::chrono::steady_clock::time_point end, size_t n)
+{
+  const std::chrono::steady_clock::time_point epoch = TraceEpoch();
+  TTraceEvent e = { name, cat, std::chrono::duration<double, std::micro>(start - epoch).count(),
+    std::chrono::duration<double, std::micro>(end - start).count(), n };
+  TraceThisThread().events.push_back(e);
+}
+
+inline void TraceWrite(std::ostream& ostr)
+{
+  std::lock_guard<std::mutex> lock(TraceMutex());
+  const std::ios_base::fmtflags flags = ostr.flags();
+  const std::streamsize precision = ostr.precision();
+  ostr << "{\"traceEvents\":[";
+  const char* sep = "\n";
+  ostr << std::fixed << std::setprecision(3);
+  for (const TTraceThread& t : TraceThreads())
+  {
+    ostr << sep << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t.tid
+      << ",\"args\":{\"name\":\"thread " << t.tid << "\"}}";
+    sep = ",\n";
+    for (const TTraceEvent& e : t.events)
+    {
+      ostr << sep << "{\"name\":\"" << e.name << "\",\"cat\":\"" << e.cat << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+        << t.tid << ",\"ts\":" << e.ts << ",\"dur\":" << e.dur;
+      if (e.n != 0)
+        ostr << ",\"args\":{\"n\":" << e.n << "}";
+      ostr << "}";
+    }
+  }
+  ostr << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  ostr.flags(flags);
+  ostr.precision(precision);
+}
+
+inline bool TraceWrite(const char* filename)
+{
+  std::ofstream f(filename);
+  if (!f)
+    return false;
+  TraceWrite(f);
+  return bool(f);
+}
+
+// Событие на время жизни объекта (если запись включена при создании)
+class TTraceScope
+{
+  const char* name;
+  const char* cat;
+  size_t n;
+  bool active;
+  std::chrono::steady_clock::time_point start;
+
+  TTraceScope(const TTraceScope&) = delete;
+  TTraceScope& operator=(const TTraceScope&) = delete;
+public:
+  TTraceScope(const char* name_, const char* cat_, size_t n_) : name(name_), cat(cat_), n(n_), active(TraceActive())
+  {
+    if (active)
+      start = std::chrono::steady_clock::now();
+  }
+  ~TTraceScope()
+  {
+    if (active)
+      TraceRecord(name, cat, start, std::chrono::steady_clock::now(), n);
+  }
+};
+
+#endif
@@ -0,0 +1,256 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Параметры ядер, зависящие от машины: размеры блоков умножения и
+// транспонирования, порог распараллеливания редукций. Значения по
+// умолчанию выводятся из размеров кэшей (sysfs), подобранные замерами
+// (tautotune.h) сохраняются в файл настройки и читаются при первом
+// обращении к Tuning(). Файл привязан к сигнатуре машины (модель
+// процессора, кэши, число потоков) и на другой машине не применяется
+//
+//
+
+#ifndef __TTune_H__
+#define __TTune_H__
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// Параметры ядер (размеры - в элементах):
+//  multiply_rows, multiply_depth, multiply_cols - блок умножения: строки
+//    результата, обрабатываемые вместе, и панель второго множителя
+//    multiply_depth x multiply_cols, переиспользуемая этими строками
+//    (0 - вся длина). Порядок сложений от блоков не зависит, результат
+//    совпадает поэлементно при любых значениях;
+//  transpose_block - сторона квадратного блока транспонирования;
+//  reduce_parallel_blocks - число листов редукции, начиная с которого
+//    листья считаются параллельно (длина листа REDUCE_BLOCK фиксирована,
+//    так как задает порядок суммирования)
+struct TTuning
+{
+  size_t multiply_rows;
+  size_t multiply_depth;
+  size_t multiply_cols;
+  size_t transpose_block;
+  size_t reduce_parallel_blocks;
+};
+
+// размеры кэшей данных в байтах, 0 - уровень отсутствует или неизвестен
+struct TCacheInfo
+{
+  size_t l1d, l2, l3;
+};
+
+inline TCacheInfo ReadCacheSizes()
+{
+  TCacheInfo info = { 0, 0, 0 };
+#if defined(__linux__)
+  for (int index = 0; index < 8; index++)
+  {
+    char path[96], type[32];
+    int level = 0;
+    size_t size = 0;
+    char unit = 0;
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+    FILE* f = std::fopen(path, "r");
+    if (!f)
+      break;
+    const bool ok = std::fscanf(f, "%d", &level) == 1;
+    std::fclose(f);
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+    f = std::fopen(path, "r");
+    if (!f)
+      continue;
+    const bool typed = std::fscanf(f, "%31s", type) == 1;
+    std::fclose(f);
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+    f = std::fopen(path, "r");
+    if (!f)
+      continue;
+    // формат: "48K", "2048K", "300M"
+    const int read = std::fscanf(f, "%zu%c", &size, &unit);
+    std::fclose(f);
+    if (!ok || !typed || read < 1 || std::strcmp(type, "Instruction") == 0)
+      continue;
+    if (unit == 'K')
+      size <<= 10;
+    else if (unit == 'M')
+      size <<= 20;
+    else if (unit == 'G')
+      size <<= 30;
+    if (level == 1)
+      info.l1d = size;
+    else if (level == 2)
+      info.l2 = size;
+    else if (level == 3)
+      info.l3 = size;
+  }
+#endif
+  return info;
+}
+
+// размеры кэшей процессора 0 (читаются один раз)
+inline TCacheInfo CacheSizes()
+{
+  static const TCacheInfo info = ReadCacheSizes();
+  return info;
+}
+
+// Сигнатура машины для файла настройки
+inline std::string TuningSignature()
+{
+  std::string model = "unknown";
+#if defined(__linux__)
+  FILE* f = std::fopen("/proc/cpuinfo", "r");
+  if (f)
+  {
+    char line[256];
+    while (std::fgets(line, sizeof(line), f))
+      if (std::strncmp(line, "model name", 10) == 0)
+      {
+        const char* v = std::strchr(line, ':');
+        if (v != nullptr)
+        {
+          model = v + 1 + std::strspn(v + 1, " \t");
+          model.erase(model.find_last_not_of(" \t\r\n") + 1);
+        }
+        break;
+      }
+    std::fclose(f);
+  }
+#endif
+  const TCacheInfo c = CacheSizes();
+  return "cpu=" + model + ";l1d=" + std::to_string(c.l1d) + ";l2=" + std::to_string(c.l2) +
+    ";l3=" + std::to_string(c.l3) + ";threads=" + std::to_string(std::thread::hardware_concurrency());
+}
+
+// Значения по кэшам: панель умножения double занимает половину L2,
+// блок транспонирования (источник и результат) - половину L1
+inline TTuning DefaultTuning()
+{
+  const TCacheInfo c = CacheSizes();
+  const size_t l1 = c.l1d != 0 ? c.l1d : 32 << 10;
+  const size_t l2 = c.l2 != 0 ? c.l2 : 1 << 20;
+  TTuning t;
+  t.multiply_rows = 8;
+  t.multiply_depth = 128;
+  t.multiply_cols = 64;
+  while (t.multiply_cols * 2 * t.multiply_depth * sizeof(double) <= l2 / 2)
+    t.multiply_cols *= 2;
+  t.transpose_block = 8;
+  while ((t.transpose_block * 2) * (t.transpose_block * 2) * 2 * sizeof(double) <= l1 / 2)
+    t.transpose_block *= 2;
+  t.reduce_parallel_blocks = 8;
+  return t;
+}
+
+// Границы размеров блоков: блок не больше наибольшей матрицы
+// (MAX_MATRIX_SIZE в tmatrix.h), буфер строк блока умножения, который
+// каждый поток выделяет для широкого накопителя, - не больше
+// TUNING_MAX_BUFFER байт (ошибка выделения в параллельной области
+// завершила бы программу)
+const size_t TUNING_MAX_BLOCK = 10000;
+const size_t TUNING_MAX_BUFFER = 64 << 20;
+
+inline bool TuningValid(const TTuning& t)
+{
+  return t.multiply_rows != 0 && t.transpose_block != 0 && t.reduce_parallel_blocks != 0 &&
+    t.multiply_rows <= TUNING_MAX_BUFFER / (TUNING_MAX_BLOCK * sizeof(double)) &&
+    t.multiply_depth <= TUNING_MAX_BLOCK && t.multiply_cols <= TUNING_MAX_BLOCK &&
+    t.transpose_block <= TUNING_MAX_BLOCK;
+}
+
+// Имя файла настройки: переменная окружения TMATRIX_TUNING_FILE или
+// tmatrix_tuning.txt в текущем каталоге
+inline const char* TuningFileName()
+{
+  const char* name = std::getenv("TMATRIX_TUNING_FILE");
+  return name != nullptr && *name != 0 ? name : "tmatrix_tuning.txt";
+}
+
+// Формат файла - строки "ключ значение", первая - сигнатура машины
+inline bool SaveTuning(const char* filename, const TTuning& t)
+{
+  FILE* f = std::fopen(filename, "w");
+  if (!f)
+    return false;
+  std::fprintf(f, "signature %s\n", TuningSignature().c_str());
+  std::fprintf(f, "multiply_rows %zu\nmultiply_depth %zu\nmultiply_cols %zu\n",
+    t.multiply_rows, t.multiply_depth, t.multiply_cols);
+  std::fprintf(f, "transpose_block %zu\nreduce_parallel_blocks %zu\n", t.transpose_block, t.reduce_parallel_blocks);
+  return std::fclose(f) == 0;
+}
+
+// false (t не изменяется), если файла нет, он поврежден или записан
+// на другой машине
+inline bool LoadTuning(const char* filename, TTuning& t)
+{
+  FILE* f = std::fopen(filename, "r");
+  if (!f)
+    return false;
+  char line[512];
+  bool signed_ok = false;
+  if (std::fgets(line, sizeof(line), f) && std::strncmp(line, "signature ", 10) == 0)
+  {
+    std::string sig = line + 10;
+    sig.erase(sig.find_last_not_of("\r\n") + 1);
+    signed_ok = sig == TuningSignature();
+  }
+  TTuning r;
+  unsigned found = 0;
+  const char* keys[5] = { "multiply_rows", "multiply_depth", "multiply_cols", "transpose_block", "reduce_parallel_blocks" };
+  size_t* values[5] = { &r.multiply_rows, &r.multiply_depth, &r.multiply_cols, &r.transpose_block, &r.reduce_parallel_blocks };
+  char key[64];
+  size_t value;
+  while (signed_ok && std::fgets(line, sizeof(line), f))
+  {
+    if (std::sscanf(line, "%63s %zu", key, &value) != 2)
+      continue;
+    for (int k = 0; k < 5; k++)
+      if (std::strcmp(key, keys[k]) == 0)
+      {
+        *values[k] = value;
+        found |= 1u << k;
+      }
+  }
+  std::fclose(f);
+  if (!signed_ok || found != 31 || !TuningValid(r))
+    return false;
+  t = r;
+  return true;
+}
+
+// прочитаны ли текущие параметры из файла настройки
+inline bool& TuningLoaded()
+{
+  static bool loaded = false;
+  return loaded;
+}
+
+inline TTuning InitialTuning()
+{
+  TTuning t = DefaultTuning();
+  TuningLoaded() = LoadTuning(TuningFileName(), t);
+  return t;
+}
+
+// Текущие параметры. Изменяются (SetTuning), когда операции
+// не выполняются
+inline TTuning& Tuning()
+{
+  static TTuning tuning = InitialTuning();
+  return tuning;
+}
+
+inline void SetTuning(const TTuning& t)
+{
+  if (!TuningValid(t))
+    throw std::invalid_argument("Tuning block sizes should be positive and bounded");
+  Tuning() = t;
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include "tbatch.h"
+
+#include <gtest.h>
+
+TEST(TMatrixBatch, can_set_and_get_matrix)
+{
+  TMatrixBatch<int> batch(3, 20);
+  TDynamicMatrix<int> m(3);
+  m[1][2] = 7;
+  batch.set(17, m);
+
+  EXPECT_EQ(m, batch.get(17));
+  EXPECT_EQ(7, batch(17, 1, 2));
+}
+
+TEST(TMatrixBatch, throws_when_set_matrix_of_other_size)
+{
+  TMatrixBatch<int> batch(3, 4);
+  TDynamicMatrix<int> m(4);
+
+  ASSERT_ANY_THROW(batch.set(0, m));
+}
+
+TEST(TMatrixBatch, batch_product_matches_matrix_product)
+{
+  const size_t n = 5, count = 37;
+  TMatrixBatch<int> a(n, count), b(n, count), c;
+  for (size_t k = 0; k < count; k++)
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+      {
+        a(k, i, j) = int(k + i * 3 + j) % 7 - 3;
+        b(k, i, j) = int(k * 2 + i + j * 5) % 5 - 2;
+      }
+  BatchMultiply(a, b, c);
+
+  for (size_t k = 0; k < count; k++)
+    EXPECT_EQ(a.get(k) * b.get(k), c.get(k));
+}
+
+TEST(TMatrixBatch, batch_matvec_matches_matrix_vector_product)
+{
+  const size_t n = 4, count = 19;
+  TMatrixBatch<double> a(n, count);
+  TVectorBatch<double> x(n, count), y;
+  for (size_t k = 0; k < count; k++)
+    for (size_t i = 0; i < n; i++)
+    {
+      x(k, i) = double(k) - double(i);
+      for (size_t j = 0; j < n; j++)
+        a(k, i, j) = double(k + i * j);
+    }
+  BatchMultiply(a, x, y);
+
+  for (size_t k = 0; k < count; k++)
+    EXPECT_EQ(a.get(k) * x.get(k), y.get(k));
+}
+
+TEST(TMatrixBatch, cant_multiply_batches_of_different_shape)
+{
+  TMatrixBatch<int> a(3, 4), b(3, 5), c;
+
+  ASSERT_ANY_THROW(BatchMultiply(a, b, c));
+}
+
+TEST(TMatrixBatch, cant_multiply_into_operand)
+{
+  TMatrixBatch<int> a(3, 4), b(3, 4);
+  TVectorBatch<int> x(3, 4);
+
+  ASSERT_THROW(BatchMultiply(a, b, a), invalid_argument);
+  ASSERT_THROW(BatchMultiply(a, b, b), invalid_argument);
+  ASSERT_THROW(BatchMultiply(a, x, x), invalid_argument);
+}
@@ -0,0 +1,73 @@
+#include "tbitmatrix.h"
+
+#include <gtest.h>
+
+TEST(TBitMatrix, can_set_and_get_element)
+{
+  TBitMatrix m(100);
+  m.set(3, 70, true);
+
+  EXPECT_TRUE(m.get(3, 70));
+  EXPECT_FALSE(m.get(70, 3));
+  EXPECT_EQ(1u, m.count());
+}
+
+TEST(TBitMatrix, throws_when_get_element_with_too_large_index)
+{
+  TBitMatrix m(10);
+
+  ASSERT_ANY_THROW(m.at(10, 0));
+}
+
+TEST(TBitMatrix, can_convert_from_and_to_dense_matrix)
+{
+  TDynamicMatrix<int> d(70, GENERATE, [](size_t i, size_t j) { return int((i * 31 + j * 17 + 1) % 7 < 2); });
+
+  EXPECT_EQ(d, TBitMatrix(d).ToMatrix<int>());
+}
+
+TEST(TBitMatrix, gf2_product_matches_dense_product_modulo_two)
+{
+  const size_t n = 75;
+  TDynamicMatrix<int> a(n, GENERATE, [](size_t i, size_t j) { return int((i * 31 + j * 17 + 2) % 7 < 2); });
+  TDynamicMatrix<int> b(n, GENERATE, [](size_t i, size_t j) { return int((i * 31 + j * 17 + 5) % 7 < 2); });
+  TDynamicMatrix<int> c = a * b;
+  TBitMatrix p = MultiplyGF2(TBitMatrix(a), TBitMatrix(b));
+
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      EXPECT_EQ(c[i][j] % 2 == 1, p.get(i, j));
+}
+
+TEST(TBitMatrix, boolean_product_matches_dense_product)
+{
+  const size_t n = 130;
+  TDynamicMatrix<int> a(n, GENERATE, [](size_t i, size_t j) { return int((i * 31 + j * 17 + 3) % 7 < 2); });
+  TDynamicMatrix<int> b(n, GENERATE, [](size_t i, size_t j) { return int((i * 31 + j * 17 + 4) % 7 < 2); });
+
+  EXPECT_EQ(TBitMatrix(a * b), MultiplyBoolean(TBitMatrix(a), TBitMatrix(b)));
+}
+
+TEST(TBitMatrix, gf2_matrix_vector_product_uses_parity)
+{
+  TBitMatrix m(3);
+  m.set(0, 0, true); m.set(0, 1, true);
+  m.set(1, 1, true);
+  TDynamicVector<uint64_t> x(1);
+  x[0] = 3;
+
+  EXPECT_EQ(2u, MultiplyGF2(m, x)[0]);
+}
+
+TEST(TBitMatrix, transitive_closure_of_path_is_upper_triangle)
+{
+  const size_t n = 80;
+  TBitMatrix m(n);
+  for (size_t i = 0; i + 1 < n; i++)
+    m.set(i, i + 1, true);
+  TBitMatrix c = TransitiveClosure(m);
+
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      EXPECT_EQ(j > i, c.get(i, j));
+}
@@ -0,0 +1,84 @@
+#include "tmatfunc.h"
+
+#include <gtest.h>
+
+// восстанавливает выбор реализации после теста
+class TBlasBackendGuard
+{
+  TBlasBackend saved;
+public:
+  TBlasBackendGuard() : saved(BlasBackend()) {}
+  ~TBlasBackendGuard() { SetBlasBackend(saved); }
+};
+
+TEST(TBlas, default_backend_depends_on_build)
+{
+  EXPECT_EQ(SystemBlasAvailable(), BlasBackend() == BLAS_SYSTEM);
+  EXPECT_FALSE(UseSystemBlas<int>());
+}
+
+TEST(TBlas, builtin_backend_is_used_when_selected)
+{
+  TBlasBackendGuard guard;
+  SetBlasBackend(BLAS_BUILTIN);
+
+  EXPECT_FALSE(UseSystemBlas<double>());
+}
+
+TEST(TBlas, backends_agree_on_matrix_product)
+{
+  TBlasBackendGuard guard;
+  TDynamicMatrix<double> a(150, GENERATE, [](size_t i, size_t j) { return double((i * 31 + j * 17 + 1) % 13) / 7 - 0.8; });
+  TDynamicMatrix<double> b(150, GENERATE, [](size_t i, size_t j) { return double((i * 31 + j * 17 + 2) % 13) / 7 - 0.8; });
+  SetBlasBackend(BLAS_BUILTIN);
+  TDynamicMatrix<double> builtin = a * b;
+  SetBlasBackend(BLAS_SYSTEM);
+  TDynamicMatrix<double> system = a * b;
+
+  EXPECT_TRUE(system.approx_equal(builtin, 1e-12, 1e-12));
+}
+
+TEST(TBlas, backends_agree_on_vector_operations)
+{
+  TBlasBackendGuard guard;
+  TDynamicMatrix<float> a(200, GENERATE, [](size_t i, size_t j) { return float((i + 3 * j) % 7) - 3; });
+  TDynamicVector<float> x(200, GENERATE, [](size_t i) { return float(i % 5); });
+  SetBlasBackend(BLAS_BUILTIN);
+  TDynamicVector<float> y1 = a * x;
+  float d1 = x * x;
+  SetBlasBackend(BLAS_SYSTEM);
+  TDynamicVector<float> y2 = a * x;
+  float d2 = x * x;
+
+  EXPECT_EQ(y1, y2);
+  EXPECT_EQ(d1, d2);
+}
+
+TEST(TBlas, system_backend_works_on_matrix_views)
+{
+  TBlasBackendGuard guard;
+  SetBlasBackend(BLAS_SYSTEM);
+  double buf[2 * 3] = { 1, 2, 0, 3, 4, 0 };
+  TDynamicMatrix<double> m(buf, 2, VIEW, 3), e(2, FILL, 0.0);
+  e[0][0] = e[1][1] = 1;
+  TDynamicMatrix<double> r = m * e;
+  TDynamicVector<double> x(2, FILL, 1.0);
+  TDynamicVector<double> y = m * x;
+
+  EXPECT_EQ(4.0, r[1][1]);
+  EXPECT_EQ(7.0, y[1]);
+}
+
+TEST(TBlas, backends_agree_on_triangular_solve)
+{
+  TBlasBackendGuard guard;
+  TDynamicMatrix<double> l(120, GENERATE, [](size_t i, size_t j) { return j > i ? 0.0 : i == j ? 4.0 : 0.01 * double((i + j) % 9); });
+  TDynamicMatrix<double> b1(120, GENERATE, [](size_t i, size_t j) { return double((i * 31 + j * 17 + 3) % 13) / 7 - 0.8; });
+  TDynamicMatrix<double> b2 = b1;
+  SetBlasBackend(BLAS_BUILTIN);
+  TriangularSolve(l, b1, TRIANGLE_LOWER);
+  SetBlasBackend(BLAS_SYSTEM);
+  TriangularSolve(l, b2, TRIANGLE_LOWER);
+
+  EXPECT_TRUE(b2.approx_equal(b1, 1e-12, 1e-12));
+}
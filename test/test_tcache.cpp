@@ -0,0 +1,67 @@
+#include "tcache.h"
+
+#include <gtest.h>
+
+TEST(TProductCache, repeated_product_is_taken_from_cache)
+{
+  TProductCache<int> cache(1 << 20);
+  TDynamicMatrix<int> a(8, GENERATE, [](size_t i, size_t j) { return int(i * 3 + j + 1) % 5; });
+  TDynamicMatrix<int> b(8, GENERATE, [](size_t i, size_t j) { return int(i * 3 + j + 2) % 5; });
+
+  EXPECT_EQ(a * b, cache.multiply(a, b));
+  EXPECT_EQ(a * b, cache.multiply(a, b));
+  EXPECT_EQ(1u, cache.hits());
+  EXPECT_EQ(1u, cache.misses());
+}
+
+TEST(TProductCache, operand_order_matters)
+{
+  TProductCache<int> cache(1 << 20);
+  TDynamicMatrix<int> a(4, GENERATE, [](size_t i, size_t j) { return int(i * 3 + j + 1) % 5; });
+  TDynamicMatrix<int> b(4, GENERATE, [](size_t i, size_t j) { return int(i * 3 + j + 2) % 5; });
+  cache.multiply(a, b);
+
+  EXPECT_EQ(b * a, cache.multiply(b, a));
+  EXPECT_EQ(0u, cache.hits());
+}
+
+TEST(TProductCache, evicts_least_recently_used_entry)
+{
+  TDynamicMatrix<int> a(16, GENERATE, [](size_t i, size_t j) { return int(i * 3 + j) % 5; });
+  TDynamicMatrix<int> b(16, GENERATE, [](size_t i, size_t j) { return int(i * 3 + j + 1) % 5; });
+  TDynamicMatrix<int> c(16, GENERATE, [](size_t i, size_t j) { return int(i * 3 + j + 2) % 5; });
+  TProductCache<int> probe(1 << 20);
+  probe.multiply(a, b);
+  TProductCache<int> cache(2 * probe.bytes() + probe.bytes() / 2);
+
+  cache.multiply(a, b);
+  cache.multiply(a, c);
+  cache.multiply(a, b);
+  cache.multiply(b, c);
+
+  EXPECT_EQ(2u, cache.entries());
+  EXPECT_EQ(1u, cache.evictions());
+  cache.multiply(a, b);
+  EXPECT_EQ(2u, cache.hits());
+}
+
+TEST(TProductCache, does_not_store_entries_larger_than_capacity)
+{
+  TProductCache<int> cache(16);
+  TDynamicMatrix<int> a(8, GENERATE, [](size_t i, size_t j) { return int(i * 3 + j + 1) % 5; });
+  cache.multiply(a, a);
+
+  EXPECT_EQ(0u, cache.entries());
+  EXPECT_EQ(0u, cache.bytes());
+}
+
+TEST(TProductCache, can_use_user_version_keys)
+{
+  TProductCache<int> cache(1 << 20);
+  TDynamicMatrix<int> a(3, GENERATE, [](size_t i, size_t j) { return int(i * 3 + j + 1) % 5; });
+  THash128 v1 = { 1, 0 };
+  TDynamicMatrix<int> first = cache.multiply(a, v1, a, v1);
+  a[0][0] = 100;
+
+  EXPECT_EQ(first, cache.multiply(a, v1, a, v1));
+}
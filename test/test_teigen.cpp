@@ -0,0 +1,79 @@
+#include "teigen.h"
+
+#include <gtest.h>
+
+template<typename T>
+static TDynamicMatrix<T> make_symmetric(size_t n)
+{
+  TDynamicMatrix<T> m(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j <= i; j++)
+      m[i][j] = m[j][i] = T((i * 7 + j * 3) % 11) - T(5) + (i == j ? T(n) : T());
+  return m;
+}
+
+template<typename T>
+static T eigen_residual(TDynamicMatrix<T>& m, TDynamicVector<T>& values, TDynamicMatrix<T>& vectors)
+{
+  T res = T();
+  for (size_t k = 0; k < m.size(); k++)
+  {
+    TDynamicVector<T> av = m * vectors[k];
+    for (size_t i = 0; i < m.size(); i++)
+      res = std::max(res, std::abs(av[i] - values[k] * vectors[k][i]));
+  }
+  return res;
+}
+
+TEST(TEigen, jacobi_finds_eigenvalues_of_diagonal_matrix)
+{
+  TDynamicMatrix<double> m(3), v;
+  TDynamicVector<double> d;
+  m[0][0] = 3; m[1][1] = 1; m[2][2] = 2;
+  EigenJacobi(m, d, v);
+
+  EXPECT_DOUBLE_EQ(1, d[0]);
+  EXPECT_DOUBLE_EQ(2, d[1]);
+  EXPECT_DOUBLE_EQ(3, d[2]);
+  EXPECT_DOUBLE_EQ(1, std::abs(v[0][1]));
+}
+
+TEST(TEigen, jacobi_satisfies_eigen_equation)
+{
+  TDynamicMatrix<double> m = make_symmetric<double>(15), v;
+  TDynamicVector<double> d;
+  EigenJacobi(m, d, v);
+
+  EXPECT_LT(eigen_residual(m, d, v), 1e-10);
+}
+
+TEST(TEigen, tridiagonal_qr_satisfies_eigen_equation)
+{
+  TDynamicMatrix<double> m = make_symmetric<double>(40), v;
+  TDynamicVector<double> d;
+  EigenTridiagonalQR(m, d, v);
+
+  EXPECT_LT(eigen_residual(m, d, v), 1e-10);
+}
+
+TEST(TEigen, both_methods_give_same_eigenvalues)
+{
+  TDynamicMatrix<double> m = make_symmetric<double>(21), v1, v2;
+  TDynamicVector<double> d1, d2;
+  EigenJacobi(m, d1, v1);
+  EigenTridiagonalQR(m, d2, v2);
+
+  for (size_t i = 0; i < m.size(); i++)
+    EXPECT_NEAR(d1[i], d2[i], 1e-10);
+}
+
+TEST(TEigen, eigenvectors_are_orthonormal)
+{
+  TDynamicMatrix<double> m = make_symmetric<double>(EIGEN_JACOBI_MAX_SIZE + 10), v;
+  TDynamicVector<double> d;
+  SymmetricEigen(m, d, v);
+
+  for (size_t i = 0; i < m.size(); i++)
+    for (size_t j = 0; j < m.size(); j++)
+      EXPECT_NEAR(i == j ? 1.0 : 0.0, v[i] * v[j], 1e-10);
+}
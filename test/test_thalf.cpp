@@ -0,0 +1,57 @@
+#include "thalf.h"
+
+#include <gtest.h>
+
+TEST(THalf, has_two_bytes_size)
+{
+  EXPECT_EQ(2u, sizeof(THalf));
+  EXPECT_EQ(2u, sizeof(TBFloat16));
+}
+
+TEST(THalf, represents_small_integers_exactly)
+{
+  for (int i = -2048; i <= 2048; i++)
+    EXPECT_EQ(float(i), float(THalf(float(i))));
+}
+
+TEST(THalf, rounds_to_nearest_even)
+{
+  // между 2048 и 2050 половина шага округляется к четной мантиссе
+  EXPECT_EQ(2048.0f, float(THalf(2049.0f)));
+  EXPECT_EQ(2052.0f, float(THalf(2051.0f)));
+}
+
+TEST(THalf, handles_overflow_and_subnormals)
+{
+  EXPECT_EQ(0x7c00, THalf(1e6f).raw());
+  EXPECT_EQ(0x0001, THalf(5.9604645e-8f).raw());
+  EXPECT_EQ(65504.0f, float(THalf::from_raw(0x7bff)));
+}
+
+TEST(TBFloat16, keeps_float_exponent_range)
+{
+  EXPECT_EQ(1.0f, float(TBFloat16(1.0f)));
+  EXPECT_NEAR(1e30f, float(TBFloat16(1e30f)), 1e30f / 256);
+  EXPECT_NE(0, TBFloat16(1e-30f).raw());
+}
+
+TEST(THalf, vector_dot_product_accumulates_in_float)
+{
+  // сумма 4096 единиц в half застряла бы на 2048
+  TDynamicVector<THalf> a(4096), b(4096);
+  for (size_t i = 0; i < a.size(); i++)
+    a[i] = b[i] = 1.0f;
+
+  EXPECT_EQ(4096.0f, float(a * b));
+}
+
+TEST(THalf, matrix_product_accumulates_in_float)
+{
+  const size_t n = 600;
+  TDynamicMatrix<TBFloat16> m(n);
+  for (size_t i = 0; i < n; i++)
+    m[0][i] = m[i][0] = 1.0f;
+  TDynamicMatrix<TBFloat16> p = m * m;
+
+  EXPECT_EQ(float(TBFloat16(600.0f)), float(p[0][0]));
+}
@@ -0,0 +1,79 @@
+#include "thash.h"
+
+#include <gtest.h>
+
+TEST(THash, equal_vectors_have_equal_hashes)
+{
+  TDynamicVector<int> a(10000), b(10000);
+  for (size_t i = 0; i < a.size(); i++)
+    a[i] = b[i] = int(i * 7);
+
+  EXPECT_EQ(Hash(a), Hash(b));
+}
+
+// эталонные значения (little-endian): хеш не должен меняться между
+// запусками, сборками и числом потоков
+TEST(THash, hash_is_stable_between_runs)
+{
+  TDynamicVector<int> v(3);
+  v[0] = 1; v[1] = 2; v[2] = 3;
+  THash128 h = Hash(v);
+
+  EXPECT_EQ(0x211480d8b6ff2e69ull, h.lo);
+  EXPECT_EQ(0x9472fff2722b8a25ull, h.hi);
+}
+
+TEST(THash, long_vector_hash_is_stable_between_runs)
+{
+  TDynamicVector<int> v(100000);
+  for (size_t i = 0; i < v.size(); i++)
+    v[i] = int(i * 7);
+  THash128 h = Hash(v);
+
+  EXPECT_EQ(0x0b2f365803bdd455ull, h.lo);
+  EXPECT_EQ(0x208649a2765075dfull, h.hi);
+}
+
+TEST(THash, hash_depends_on_every_element_and_length)
+{
+  TDynamicVector<int> a(50000), b(50000), c(50001);
+  b[49999] = 1;
+
+  EXPECT_NE(Hash(a), Hash(b));
+  EXPECT_NE(Hash(a), Hash(c));
+}
+
+TEST(THash, hash_depends_on_element_order)
+{
+  TDynamicVector<long long> a(2), b(2);
+  a[0] = 1; b[1] = 1;
+
+  EXPECT_NE(Hash(a), Hash(b));
+}
+
+TEST(THash, incremental_matrix_hash_matches_full_rehash)
+{
+  TDynamicMatrix<double> m(37);
+  for (size_t i = 0; i < m.size(); i++)
+    for (size_t j = 0; j < m.size(); j++)
+      m[i][j] = double(i) / double(j + 1);
+  TMatrixHasher<double> hasher(m);
+  THash128 before = hasher.value();
+
+  EXPECT_EQ(Hash(m), before);
+
+  m[20][3] = 42.0;
+  hasher.update_row(m, 20);
+
+  EXPECT_NE(before, hasher.value());
+  EXPECT_EQ(Hash(m), hasher.value());
+}
+
+TEST(THash, cant_update_row_hash_of_other_size)
+{
+  TDynamicMatrix<double> m(4), other(5);
+  TMatrixHasher<double> hasher(m);
+
+  ASSERT_ANY_THROW(hasher.update_row(other, 0));
+  ASSERT_ANY_THROW(hasher.update_row(m, 4));
+}
@@ -0,0 +1,92 @@
+#include "tmatfunc.h"
+
+#include <gtest.h>
+
+TEST(TMatFunc, zero_power_is_identity)
+{
+  EXPECT_EQ(IdentityMatrix<int>(4), pow(TDynamicMatrix<int>(4), 0));
+}
+
+TEST(TMatFunc, power_matches_repeated_product)
+{
+  TDynamicMatrix<long long> a(6, GENERATE, [](size_t i, size_t j) { return (long long)((i + 2 * j) % 3) - 1; });
+  TDynamicMatrix<long long> expected = a;
+  for (int k = 2; k <= 13; k++)
+  {
+    expected = expected * a;
+    EXPECT_EQ(expected, pow(a, k));
+  }
+}
+
+TEST(TMatFunc, can_compute_large_fibonacci_power)
+{
+  TDynamicMatrix<unsigned long long> f(2);
+  f[0][0] = f[0][1] = f[1][0] = 1;
+
+  EXPECT_EQ(12586269025ull, pow(f, 50)[0][1]);
+}
+
+TEST(TMatFunc, polynomial_value_matches_horner_scheme)
+{
+  TDynamicMatrix<long long> a(5, GENERATE, [](size_t i, size_t j) { return (long long)((i + 2 * j) % 3) - 1; });
+  for (size_t d = 0; d <= 11; d++)
+  {
+    TDynamicVector<long long> c(d + 1);
+    for (size_t i = 0; i <= d; i++)
+      c[i] = (long long)(i % 4) - 1;
+    TDynamicMatrix<long long> expected(5);
+    for (size_t i = d + 1; i-- > 0;)
+      expected = expected * a + IdentityMatrix<long long>(5) * c[i];
+
+    EXPECT_EQ(expected, PolynomialValue(c, a));
+  }
+}
+
+TEST(TMatFunc, can_add_scaled_vector)
+{
+  TDynamicVector<double> y(3, FILL, 1.0), x(3, GENERATE, [](size_t i) { return double(i); });
+  AddScaled(y, 2.0, x);
+
+  EXPECT_EQ(5.0, y[2]);
+  ASSERT_ANY_THROW(AddScaled(y, 1.0, TDynamicVector<double>(4)));
+}
+
+TEST(TMatFunc, triangular_solve_inverts_lower_and_upper_products)
+{
+  const size_t n = 300;
+  TDynamicMatrix<double> l(n, GENERATE, [](size_t i, size_t j) { return j > i ? 0.0 : i == j ? 2.0 + i % 3 : 1.0 / (1 + i + j); });
+  TDynamicMatrix<double> u(n, GENERATE, [&l](size_t i, size_t j) { return l[j][i]; });
+  TDynamicMatrix<double> x(n, GENERATE, [](size_t i, size_t j) { return double((i * 7 + j) % 5) - 2; });
+  TDynamicMatrix<double> bl = l * x, bu = u * x;
+  TriangularSolve(l, bl, TRIANGLE_LOWER);
+  TriangularSolve(u, bu, TRIANGLE_UPPER);
+
+  EXPECT_TRUE(bl.approx_equal(x, 1e-9));
+  EXPECT_TRUE(bu.approx_equal(x, 1e-9));
+}
+
+TEST(TMatFunc, triangular_solve_with_vector_right_hand_side)
+{
+  TDynamicMatrix<double> u(3, FILL, 0.0);
+  u[0][0] = 2; u[0][1] = 1; u[0][2] = 1;
+  u[1][1] = 4; u[1][2] = 2;
+  u[2][2] = 5;
+  TDynamicVector<double> b(3);
+  b[0] = 7; b[1] = 16; b[2] = 15;
+  TriangularSolve(u, b, TRIANGLE_UPPER);
+
+  EXPECT_NEAR(0.75, b[0], 1e-12);
+  EXPECT_NEAR(2.5, b[1], 1e-12);
+  EXPECT_NEAR(3.0, b[2], 1e-12);
+}
+
+TEST(TMatFunc, triangular_solve_throws_for_singular_matrix)
+{
+  TDynamicMatrix<double> a(3, FILL, 1.0);
+  TDynamicVector<double> b(3);
+  TDynamicMatrix<double> c(2);
+  a[1][1] = 0;
+
+  ASSERT_THROW(TriangularSolve(a, b, TRIANGLE_LOWER), runtime_error);
+  ASSERT_THROW(TriangularSolve(a, c, TRIANGLE_LOWER), length_error);
+}
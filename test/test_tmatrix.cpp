@@ -1,7 +1,29 @@
 #include "tmatrix.h"
 
+#include <numeric>
+#if __has_include(<execution>)
+#include <execution>
+#endif
+
 #include <gtest.h>
 
+#ifdef _OPENMP
+// элемент, отмечающий сравнение внутри активной параллельной области
+static std::atomic<bool> compared_in_parallel(false);
+
+struct TParallelProbe
+{
+  int v;
+  bool operator==(const TParallelProbe& p) const
+  {
+    if (omp_in_parallel())
+      compared_in_parallel = true;
+    return v == p.v;
+  }
+  bool operator!=(const TParallelProbe& p) const { return !(*this == p); }
+};
+#endif
+
 TEST(TDynamicMatrix, can_create_matrix_with_positive_length)
 {
   ASSERT_NO_THROW(TDynamicMatrix<int> m(5));
@@ -109,3 +131,274 @@ TEST(TDynamicMatrix, cant_subtract_matrixes_with_not_equal_size)
   ADD_FAILURE();
 }
 
+
+TEST(TDynamicMatrix, min_plus_product_gives_two_step_shortest_paths)
+{
+  const double inf = TMinPlus<double>::zero();
+  TDynamicMatrix<double> w(3);
+  w[0][0] = 0; w[0][1] = 4;   w[0][2] = 1;
+  w[1][0] = inf; w[1][1] = 0; w[1][2] = inf;
+  w[2][0] = inf; w[2][1] = 2; w[2][2] = 0;
+  TDynamicMatrix<double> d = w.Multiply<TMinPlus<double>>(w);
+
+  EXPECT_EQ(3, d[0][1]);
+  EXPECT_EQ(inf, d[1][0]);
+  EXPECT_EQ(0, d[2][2]);
+}
+
+TEST(TDynamicMatrix, min_plus_squaring_matches_floyd_for_integers)
+{
+  const size_t n = 70;
+  const int inf = TMinPlus<int>::zero();
+  TDynamicMatrix<int> w(n), floyd(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      w[i][j] = i == j ? 0 : ((i * 7 + j * 3) % 5 == 0 ? int((i + j) % 9 + 1) : inf);
+  floyd = w;
+  for (size_t k = 0; k < n; k++)
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        if (floyd[i][k] != inf && floyd[k][j] != inf && floyd[i][k] + floyd[k][j] < floyd[i][j])
+          floyd[i][j] = floyd[i][k] + floyd[k][j];
+  TDynamicMatrix<int> d = w;
+  for (size_t len = 1; len < n; len *= 2)
+    d = d.Multiply<TMinPlus<int>>(d);
+
+  EXPECT_EQ(floyd, d);
+}
+
+TEST(TDynamicMatrix, max_min_product_gives_bottleneck_capacity)
+{
+  TDynamicMatrix<int> c(3);
+  c[0][1] = 5; c[1][2] = 3; c[0][2] = 2;
+  for (size_t i = 0; i < 3; i++)
+    c[i][i] = 1000;
+  TDynamicMatrix<int> b = c.Multiply<TMaxMin<int>>(c);
+
+  EXPECT_EQ(3, b[0][2]);
+}
+
+TEST(TDynamicMatrix, max_plus_product_gives_longest_two_step_path)
+{
+  TDynamicMatrix<int> w(2);
+  w[0][0] = 1; w[0][1] = 2; w[1][0] = 3; w[1][1] = 4;
+  TDynamicMatrix<int> p = w.Multiply<TMaxPlus<int>>(w);
+
+  EXPECT_EQ(6, p[0][1]);
+  EXPECT_EQ(8, p[1][1]);
+}
+
+TEST(TDynamicMatrix, max_plus_product_keeps_missing_paths_for_doubles)
+{
+  const double none = TMaxPlus<double>::zero();
+  TDynamicMatrix<double> w(2);
+  w[0][0] = 0; w[0][1] = none; w[1][0] = none; w[1][1] = 0;
+  TDynamicMatrix<double> p = w.Multiply<TMaxPlus<double>>(w);
+
+  EXPECT_EQ(none, p[0][1]);
+  EXPECT_EQ(0, p[1][1]);
+}
+
+TEST(TDynamicMatrix, can_compute_trace_sum_min_and_max)
+{
+  TDynamicMatrix<int> m(100);
+  for (size_t i = 0; i < 100; i++)
+    for (size_t j = 0; j < 100; j++)
+      m[i][j] = int(i) - int(j);
+  m[40][60] = 500;
+
+  EXPECT_EQ(0, m.trace());
+  EXPECT_EQ(500 - (40 - 60), m.sum());
+  EXPECT_EQ(-99, m.min());
+  EXPECT_EQ(500, m.max());
+  EXPECT_EQ(make_pair(size_t(40), size_t(60)), m.argmax());
+  EXPECT_EQ(make_pair(size_t(0), size_t(99)), m.argmin());
+}
+
+TEST(TDynamicMatrix, can_compute_norms)
+{
+  TDynamicMatrix<double> m(2);
+  m[0][0] = 1; m[0][1] = -2;
+  m[1][0] = 3; m[1][1] = 4;
+
+  EXPECT_DOUBLE_EQ(std::sqrt(30.0), m.norm_frobenius());
+  EXPECT_EQ(6, m.norm1());
+  EXPECT_EQ(7, m.norm_inf());
+}
+
+TEST(TDynamicMatrix, column_norm_of_large_matrix_is_exact_for_integers)
+{
+  const size_t n = 300;
+  TDynamicMatrix<long long> m(n);
+  for (size_t i = 0; i < n; i++)
+    m[i][7] = (i % 2) ? -(long long)i : (long long)i;
+
+  EXPECT_EQ((long long)(n * (n - 1) / 2), m.norm1());
+}
+
+TEST(TDynamicMatrix, approx_equal_compares_with_tolerance)
+{
+  TDynamicMatrix<double> a(3), b(3);
+  b[2][1] = 1e-9;
+
+  EXPECT_FALSE(a == b);
+  EXPECT_TRUE(a.approx_equal(b, 1e-8));
+  EXPECT_FALSE(a.approx_equal(b, 1e-10));
+}
+
+TEST(TDynamicMatrix, can_create_zeroed_matrix_with_any_numa_policy)
+{
+  TNumaPolicy policies[] = { NUMA_FIRST_TOUCH, NUMA_INTERLEAVE, NUMA_PARTITION };
+  for (TNumaPolicy p : policies)
+  {
+    TDynamicMatrix<double> m(700, p);
+
+    EXPECT_EQ(700u, m.size());
+    EXPECT_EQ(0.0, m.norm_inf());
+  }
+  EXPECT_GE(NumaNodeCount(), 1);
+}
+
+TEST(TDynamicMatrix, can_create_matrix_with_fill_and_generator)
+{
+  TDynamicMatrix<int> f(3, FILL, 2);
+  TDynamicMatrix<int> g(3, GENERATE, [](size_t i, size_t j) { return int(i * 10 + j); });
+
+  EXPECT_EQ(18, f.sum());
+  EXPECT_EQ(21, g[2][1]);
+}
+
+TEST(TDynamicMatrix, exception_from_generator_is_rethrown)
+{
+  ASSERT_THROW(TDynamicMatrix<int> m(200, GENERATE, [](size_t i, size_t) -> int
+    {
+      if (i == 150)
+        throw invalid_argument("bad row");
+      return 0;
+    }), invalid_argument);
+}
+
+TEST(TDynamicMatrix, chained_operations_reuse_temporary_buffer)
+{
+  TDynamicMatrix<int> a(100, FILL, 1), b(100, FILL, 2), c(100, FILL, 3);
+  TDynamicMatrix<int> t = a + b;
+  const int* p = &t[0][0];
+  TDynamicMatrix<int> d = (std::move(t) - c) * 5 + a;
+
+  EXPECT_EQ(p, &d[0][0]);
+  EXPECT_EQ(TDynamicMatrix<int>(100, FILL, 1), d);
+}
+
+TEST(TDynamicMatrix, subtraction_from_temporary_keeps_operand_order)
+{
+  TDynamicMatrix<int> a(3, FILL, 10), b(3, FILL, 4), c(3, FILL, 1);
+  TDynamicMatrix<int> t = b - c;
+  const int* p = &t[0][0];
+  TDynamicMatrix<int> d = a - std::move(t);
+
+  EXPECT_EQ(p, &d[0][0]);
+  EXPECT_EQ(TDynamicMatrix<int>(3, FILL, 7), d);
+  EXPECT_EQ(TDynamicMatrix<int>(3, FILL, -8), (b - a) - (c + c));
+}
+
+TEST(TDynamicMatrix, can_multiply_non_const_lvalues_by_scalar)
+{
+  TDynamicVector<int> v(3, FILL, 4);
+  TDynamicMatrix<double> m(3, FILL, 1.5);
+
+  EXPECT_EQ(TDynamicVector<int>(3, FILL, 8), v * 2);
+  EXPECT_EQ(TDynamicMatrix<double>(3, FILL, 3.0), m * 2.0);
+  EXPECT_EQ(TDynamicVector<int>(3, FILL, 4), v);
+}
+
+TEST(TDynamicMatrix, element_iterators_visit_elements_in_row_order)
+{
+  TDynamicMatrix<int> m(3);
+  std::iota(m.element_begin(), m.element_end(), 0);
+  const TDynamicMatrix<int>& c = m;
+  TDynamicMatrix<int>::const_element_iterator it = c.element_begin();
+
+  EXPECT_EQ(9, c.element_end() - it);
+  EXPECT_EQ(5, m[1][2]);
+  EXPECT_EQ(7, it[7]);
+  EXPECT_EQ(3, *(it + 3));
+  EXPECT_EQ(8, *--c.element_end());
+  EXPECT_EQ(36, std::accumulate(it, c.element_end(), 0));
+}
+
+TEST(TDynamicMatrix, can_sort_elements_and_iterate_rows)
+{
+  TDynamicMatrix<int> m(4, GENERATE, [](size_t i, size_t j) { return int(16 - 4 * i - j); });
+  std::sort(m.element_begin(), m.element_end());
+  int row_sums = 0;
+  for (const TDynamicVector<int>& r : m)
+    row_sums += r.sum();
+
+  EXPECT_EQ(1, m[0][0]);
+  EXPECT_EQ(16, m[3][3]);
+  EXPECT_EQ(136, row_sums);
+  EXPECT_EQ(4, m.end() - m.begin());
+}
+
+#ifdef __cpp_lib_parallel_algorithm
+TEST(TDynamicMatrix, works_with_parallel_algorithms)
+{
+  TDynamicMatrix<double> m(300, FILL, 1.5);
+  std::transform(std::execution::par_unseq, m.element_begin(), m.element_end(), m.element_begin(), [](double x) { return 2 * x; });
+
+  EXPECT_EQ(270000.0, std::reduce(std::execution::par_unseq, m.element_begin(), m.element_end(), 0.0));
+  EXPECT_EQ(300, std::count_if(std::execution::par, m.begin(), m.end(), [](const TDynamicVector<double>& r) { return r.sum() == 900.0; }));
+}
+#endif
+
+TEST(TDynamicMatrix, view_shares_external_buffer)
+{
+  int buf[3 * 4] = { 1, 2, 3, 0, 4, 5, 6, 0, 7, 8, 9, 0 };
+  TDynamicMatrix<int> m(buf, 3, VIEW, 4);
+  m[2][2] = 90;
+
+  EXPECT_EQ(6, m[1][2]);
+  EXPECT_EQ(90, buf[10]);
+  EXPECT_FALSE(m.owns());
+  TDynamicMatrix<int> e(3, GENERATE, [](size_t i, size_t j) { return int(i == j ? 1 : 0); });
+  EXPECT_EQ(m * 1, e * m);
+  ASSERT_ANY_THROW(TDynamicMatrix<int>(buf, 3, VIEW, 2));
+}
+
+TEST(TDynamicMatrix, operations_on_temporary_view_do_not_modify_buffer)
+{
+  double buf[4] = { 1, 2, 3, 4 };
+  TDynamicMatrix<double> m = TDynamicMatrix<double>(buf, 2, VIEW) * 2.0;
+
+  EXPECT_EQ(20.0, m.sum());
+  EXPECT_EQ(1.0, buf[0]);
+  EXPECT_TRUE(m.owns());
+}
+
+#ifdef __cpp_lib_mdspan
+TEST(TDynamicMatrix, converts_to_and_from_mdspan)
+{
+  int buf[4] = { 1, 2, 3, 4 };
+  TDynamicMatrix<int> m(std::mdspan<int, std::dextents<size_t, 2>>(buf, 2, 2), VIEW);
+  auto s = m.as_mdspan();
+
+  EXPECT_EQ(3, (s[1, 0]));
+  ASSERT_ANY_THROW(TDynamicMatrix<int>(100).as_mdspan());
+}
+#endif
+
+#ifdef _OPENMP
+TEST(TDynamicMatrix, large_matrices_are_compared_in_parallel)
+{
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(2);
+  TDynamicMatrix<TParallelProbe> a(200, FILL, TParallelProbe{ 1 }), b(200, FILL, TParallelProbe{ 1 });
+  compared_in_parallel = false;
+
+  bool equal = a == b;
+  omp_set_num_threads(threads);
+
+  EXPECT_TRUE(equal);
+  EXPECT_TRUE(compared_in_parallel);
+}
+#endif
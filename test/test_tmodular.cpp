@@ -0,0 +1,69 @@
+#include "tmodular.h"
+
+#include <gtest.h>
+
+const uint32_t MOD = 998244353;
+typedef TModInt<MOD> mint;
+
+TEST(TModInt, can_convert_value_and_back)
+{
+  EXPECT_EQ(5u, mint(5).value());
+  EXPECT_EQ(MOD - 3, mint(-3).value());
+  EXPECT_EQ(1u, mint((long long)MOD + 1).value());
+}
+
+TEST(TModInt, can_add_subtract_and_multiply)
+{
+  mint a(MOD - 1), b(2);
+
+  EXPECT_EQ(1u, (a + b).value());
+  EXPECT_EQ(MOD - 3, (a - b).value());
+  EXPECT_EQ(MOD - 2, (a * b).value());
+}
+
+TEST(TModInt, inverse_gives_identity)
+{
+  mint a(123456789);
+
+  EXPECT_EQ(1u, (a * a.inverse()).value());
+}
+
+TEST(TModInt, vector_dot_product_is_reduced_once)
+{
+  TDynamicVector<mint> a(10000), b(10000);
+  unsigned long long expected = 0;
+  for (size_t i = 0; i < a.size(); i++)
+  {
+    a[i] = mint((long long)(MOD - 1 - i));
+    b[i] = mint((long long)(i * i + 7));
+    expected = (expected + (unsigned long long)(MOD - 1 - i) * ((i * i + 7) % MOD)) % MOD;
+  }
+
+  EXPECT_EQ(expected, (a * b).value());
+  EXPECT_EQ(mint(0), a.sum() - a.sum());
+}
+
+TEST(TModInt, matrix_product_matches_integer_product_modulo_p)
+{
+  const size_t n = 40;
+  TDynamicMatrix<mint> a(n), b(n);
+  TDynamicMatrix<long long> ia(n), ib(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      ia[i][j] = (long long)((i * 1000003 + j * 999983) % MOD);
+      ib[i][j] = (long long)(MOD - 1 - (i * 7 + j) % 100);
+      a[i][j] = mint(ia[i][j]);
+      b[i][j] = mint(ib[i][j]);
+    }
+  TDynamicMatrix<mint> c = a * b;
+
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      long long expected = 0;
+      for (size_t k = 0; k < n; k++)
+        expected = (expected + ia[i][k] * ib[k][j]) % MOD;
+      EXPECT_EQ((uint32_t)expected, c[i][j].value());
+    }
+}
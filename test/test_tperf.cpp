@@ -0,0 +1,141 @@
+#include "tmatrix.h"
+#include "tperf.h"
+
+#include <gtest.h>
+#include <sstream>
+
+TEST(TPerf, scope_records_site_only_when_counters_are_available)
+{
+  PerfReset();
+  {
+    TPerfScope s("test site");
+    TDynamicVector<double> v(100000, FILL, 1.0);
+    EXPECT_EQ(100000.0, v.sum());
+  }
+  TPerfStats st = PerfSiteStats("test site");
+
+  EXPECT_EQ(PerfAvailable() ? 1u : 0u, st.calls);
+  EXPECT_EQ(0u, st.available & ~PerfThisThread().available());
+  PerfReset();
+}
+
+TEST(TPerf, group_that_never_ran_is_unavailable)
+{
+  const int slot[2] = { PERF_CYCLES, PERF_INSTRUCTIONS };
+  const unsigned long long buf[5] = { 2, 1000, 0, 0, 0 };
+
+  TPerfSample s = PerfDecode(buf, slot, 2);
+
+  EXPECT_EQ(0u, s.available);
+}
+
+TEST(TPerf, group_values_are_decoded_by_slot)
+{
+  const int slot[2] = { PERF_CYCLES, PERF_PAGE_FAULTS };
+  const unsigned long long buf[5] = { 2, 1000, 500, 300, 7 };
+
+  TPerfSample s = PerfDecode(buf, slot, 2);
+
+  EXPECT_EQ((1u << PERF_CYCLES) | (1u << PERF_PAGE_FAULTS), s.available);
+  EXPECT_EQ(300u, s.value[PERF_CYCLES]);
+  EXPECT_EQ(7u, s.value[PERF_PAGE_FAULTS]);
+}
+
+TEST(TPerf, multiplexed_counts_are_scaled)
+{
+  const int slot[1] = { PERF_CYCLES };
+  const unsigned long long full[4] = { 1, 1000, 1000, 300 };
+  const unsigned long long half[4] = { 1, 2000, 1500, 600 };
+
+  TPerfSample a = PerfDecode(full, slot, 1), b = PerfDecode(half, slot, 1);
+
+  EXPECT_EQ(600u, PerfDelta(a, b, PERF_CYCLES));
+}
+
+TEST(TPerf, multiplexed_delta_is_not_negative)
+{
+  // по отдельности оценки 600 и 466: разность без общего масштаба отрицательна
+  const int slot[1] = { PERF_CYCLES };
+  const unsigned long long first[4] = { 1, 1000, 500, 300 };
+  const unsigned long long second[4] = { 1, 2000, 1500, 350 };
+
+  TPerfSample a = PerfDecode(first, slot, 1), b = PerfDecode(second, slot, 1);
+
+  EXPECT_EQ(50u, PerfDelta(a, b, PERF_CYCLES));
+}
+
+TEST(TPerf, report_keeps_stream_format)
+{
+  PerfReset();
+  TPerfSample start, end;
+  std::memset(&start, 0, sizeof(start));
+  std::memset(&end, 0, sizeof(end));
+  start.available = end.available = 1u << PERF_CYCLES;
+  end.value[PERF_CYCLES] = 100;
+  PerfAdd("test site", start, end);
+  std::ostringstream out;
+  PerfReport(out);
+  PerfReset();
+  out.str("");
+  out << 0.5;
+
+  EXPECT_EQ("0.5", out.str());
+}
+
+TEST(TPerf, derived_metrics_are_zero_without_counters)
+{
+  TPerfStats st = PerfSiteStats("site that never ran");
+
+  EXPECT_EQ(0u, st.calls);
+  EXPECT_EQ(0.0, st.ipc());
+  EXPECT_EQ(0.0, st.cache_miss_rate());
+  EXPECT_EQ(0.0, st.dtlb_mpki());
+}
+
+TEST(TPerf, derived_metrics_use_counter_ratios)
+{
+  TPerfStats st = PerfSiteStats("site that never ran");
+  st.value[PERF_CYCLES] = 1000;
+  st.value[PERF_INSTRUCTIONS] = 2000;
+  st.value[PERF_CACHE_REFERENCES] = 10;
+  st.value[PERF_CACHE_MISSES] = 4;
+
+  EXPECT_EQ(2.0, st.ipc());
+  EXPECT_EQ(0.4, st.cache_miss_rate());
+  EXPECT_EQ(2.0, st.llc_mpki());
+}
+
+TEST(TPerf, report_lists_recorded_sites)
+{
+  PerfReset();
+  {
+    TPerfScope s("reported site");
+  }
+  std::ostringstream out;
+  PerfReport(out);
+
+  EXPECT_EQ(PerfAvailable(), out.str().find("reported site") != std::string::npos);
+  PerfReset();
+}
+
+#ifdef TMATRIX_PERF
+TEST(TPerf, records_matrix_operations_and_chunks)
+{
+  // встроенное ядро: системная BLAS частей цикла не записывает
+  TBlasBackend backend = BlasBackend();
+  SetBlasBackend(BLAS_BUILTIN);
+  PerfReset();
+  TDynamicMatrix<double> a(100, FILL, 1.0), b(100, FILL, 2.0);
+  TDynamicMatrix<double> c = a * b;
+  SetBlasBackend(backend);
+
+  if (PerfAvailable())
+  {
+    EXPECT_EQ(1u, PerfSiteStats("matrix*matrix").calls);
+    EXPECT_GE(PerfSiteStats("multiply rows").calls, 1u);
+  }
+  else
+    EXPECT_EQ(0u, PerfSiteStats("matrix*matrix").calls);
+  PerfReset();
+}
+#endif
@@ -0,0 +1,101 @@
+#include "tmatrix.h"
+
+#include <gtest.h>
+#include <sstream>
+
+#ifdef TMATRIX_PROFILE
+
+TEST(TProfile, counts_vector_operations)
+{
+  ProfileReset();
+  TDynamicVector<double> a(100, FILL, 1.0), b(a);
+  TDynamicVector<double> c = a + b;
+  double d = a * c;
+
+  TProfileStats add = ProfileStats(PROF_VECTOR_ADD);
+  EXPECT_EQ(1u, add.calls);
+  EXPECT_EQ(100u, add.elements);
+  EXPECT_EQ(3 * 100 * sizeof(double), add.bytes);
+  EXPECT_EQ(1u, add.allocations);
+  EXPECT_EQ(1u, ProfileStats(PROF_VECTOR_COPY).calls);
+  EXPECT_EQ(200u, ProfileStats(PROF_VECTOR_DOT).flops);
+  EXPECT_EQ(200.0, d);
+}
+
+TEST(TProfile, temporary_operands_are_not_counted_as_allocations)
+{
+  ProfileReset();
+  TDynamicVector<int> a(10), b(10);
+  TDynamicVector<int> c = (a + b) + a;
+
+  EXPECT_EQ(2u, ProfileStats(PROF_VECTOR_ADD).calls);
+  EXPECT_EQ(1u, ProfileStats(PROF_VECTOR_ADD).allocations);
+}
+
+TEST(TProfile, counts_matrix_multiplication_flops_and_time)
+{
+  ProfileReset();
+  TDynamicMatrix<double> a(50, FILL, 1.0), b(50, FILL, 2.0);
+  TDynamicMatrix<double> c = a * b;
+
+  TProfileStats mul = ProfileStats(PROF_MATRIX_MULTIPLY);
+  EXPECT_EQ(1u, mul.calls);
+  EXPECT_EQ(2u * 50 * 50 * 50, mul.flops);
+  EXPECT_GT(mul.nanoseconds, 0u);
+  EXPECT_EQ(3u, ProfileStats(PROF_MATRIX_CREATE).calls);
+  EXPECT_EQ(3u * 51, ProfileStats(PROF_MATRIX_CREATE).allocations);
+}
+
+TEST(TProfile, counts_stream_io_and_prints_report)
+{
+  ProfileReset();
+  TDynamicVector<int> v(3);
+  std::ostringstream out;
+  out << v;
+  ProfileReport(out);
+
+  EXPECT_EQ(1u, ProfileStats(PROF_VECTOR_IO).calls);
+  EXPECT_NE(std::string::npos, out.str().find("vector io"));
+  EXPECT_EQ(std::string::npos, out.str().find("matrix*matrix"));
+}
+
+TEST(TProfile, counts_matrix_copies_separately_from_row_copies)
+{
+  ProfileReset();
+  TDynamicMatrix<int> a(10), b(a);
+  b = a;
+
+  TProfileStats copy = ProfileStats(PROF_MATRIX_COPY);
+  EXPECT_EQ(2u, copy.calls);
+  EXPECT_EQ(200u, copy.elements);
+  EXPECT_EQ(2 * 200 * sizeof(int), copy.bytes);
+  EXPECT_EQ(0u, ProfileStats(PROF_VECTOR_COPY).calls);
+}
+
+#else
+
+TEST(TProfile, counters_stay_zero_when_compiled_out)
+{
+  ProfileReset();
+  TDynamicMatrix<int> a(10), b(10);
+  TDynamicMatrix<int> c = a * b + a;
+
+  EXPECT_FALSE(ProfileEnabled());
+  EXPECT_EQ(0u, ProfileStats(PROF_MATRIX_MULTIPLY).calls);
+  EXPECT_EQ(0u, ProfileStats(PROF_MATRIX_ADD).calls);
+}
+
+#endif
+
+TEST(TProfile, report_keeps_stream_format)
+{
+  ProfileReset();
+  ProfileCounters()[PROF_VECTOR_IO].calls = 1;
+  std::ostringstream out;
+  ProfileReport(out);
+  ProfileReset();
+  out.str("");
+  out << 0.5;
+
+  EXPECT_EQ("0.5", out.str());
+}
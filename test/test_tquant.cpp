@@ -0,0 +1,94 @@
+#include "tquant.h"
+
+#include <gtest.h>
+
+TEST(TQuantMatrix, quantize_restores_representable_values)
+{
+  TDynamicMatrix<float> m(5, GENERATE, [](size_t i, size_t j) { return float(int((i * 13 + j * 7) % 19) - 9) * 0.25f; });
+  TQuantMatrix<int8_t> q = TQuantMatrix<int8_t>::Quantize(m);
+  TDynamicMatrix<float> d = q.Dequantize();
+
+  for (size_t i = 0; i < 5; i++)
+    for (size_t j = 0; j < 5; j++)
+      EXPECT_NEAR(m[i][j], d[i][j], q.row_scale(i));
+}
+
+TEST(TQuantMatrix, per_tensor_quantization_uses_one_scale)
+{
+  TDynamicMatrix<float> m(6, GENERATE, [](size_t i, size_t j) { return float(int((i * 13 + j * 7 + 3) % 19) - 9) * 0.25f; });
+  TQuantMatrix<int8_t> q = TQuantMatrix<int8_t>::Quantize(m, QUANT_PER_TENSOR);
+
+  for (size_t i = 1; i < 6; i++)
+    EXPECT_EQ(q.row_scale(0), q.row_scale(i));
+}
+
+TEST(TQuantMatrix, unsigned_quantization_clamps_negative_values)
+{
+  TDynamicMatrix<float> m(2);
+  m[0][0] = -1.0f;
+  m[0][1] = 2.0f;
+  TQuantMatrix<uint8_t> q = TQuantMatrix<uint8_t>::Quantize(m);
+
+  EXPECT_EQ(0, q[0][0]);
+  EXPECT_EQ(255, q[0][1]);
+}
+
+TEST(TQuantMatrix, int32_accumulation_matches_integer_product)
+{
+  const size_t n = 45;
+  TQuantMatrix<int8_t> a(n), b(n);
+  TDynamicMatrix<int> ia(n), ibt(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = int8_t(int((i * 31 + j * 17) % 255) - 127);
+      b[j][i] = int8_t(int((i * 5 + j * 11) % 255) - 127);
+      ia[i][j] = a[i][j];
+      ibt[i][j] = b[j][i];
+    }
+  TDynamicMatrix<int32_t> c = QuantAccumulate(a, b);
+  TDynamicMatrix<int> expected = ia * ibt;
+
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      EXPECT_EQ(expected[i][j], c[i][j]);
+}
+
+TEST(TQuantMatrix, unsigned_by_signed_product_matches_integer_product)
+{
+  const size_t n = 70;
+  TQuantMatrix<uint8_t> a(n);
+  TQuantMatrix<int8_t> b(n);
+  long long expected = 0;
+  for (size_t k = 0; k < n; k++)
+  {
+    a[3][k] = uint8_t((k * 37) % 256);
+    b[5][k] = int8_t(int((k * 19) % 256) - 128);
+    expected += (long long)a[3][k] * b[5][k];
+  }
+
+  EXPECT_EQ(expected, QuantAccumulate(a, b)[3][5]);
+}
+
+TEST(TQuantMatrix, quantized_product_approximates_float_product)
+{
+  const size_t n = 32;
+  TDynamicMatrix<float> x(n, GENERATE, [](size_t i, size_t j) { return float(int((i * 13 + j * 7 + 1) % 19) - 9) * 0.25f; });
+  TDynamicMatrix<float> w(n, GENERATE, [](size_t i, size_t j) { return float(int((i * 13 + j * 7 + 4) % 19) - 9) * 0.25f; });
+  TDynamicMatrix<float> wt(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      wt[i][j] = w[j][i];
+  TDynamicMatrix<float> expected = x * wt;
+  TDynamicMatrix<float> c = QuantMultiplyTransposed(TQuantMatrix<int8_t>::Quantize(x),
+    TQuantMatrix<int8_t>::Quantize(w));
+  TQuantMatrix<int8_t> r = QuantMultiplyRequantize<int8_t>(TQuantMatrix<int8_t>::Quantize(x),
+    TQuantMatrix<int8_t>::Quantize(w));
+
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      EXPECT_NEAR(expected[i][j], c[i][j], 0.5f);
+      EXPECT_NEAR(expected[i][j], r.row_scale(i) * r[i][j], 0.5f + r.row_scale(i));
+    }
+}
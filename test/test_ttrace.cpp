@@ -0,0 +1,100 @@
+#include "tmatrix.h"
+#include "ttrace.h"
+
+#include <gtest.h>
+#include <sstream>
+#include <string>
+#include <cstdio>
+
+static std::string trace_json()
+{
+  std::ostringstream out;
+  TraceWrite(out);
+  return out.str();
+}
+
+TEST(TTrace, scope_is_recorded_only_while_tracing)
+{
+  TraceClear();
+  {
+    TTraceScope s("idle", "test", 0);
+  }
+  EXPECT_EQ(0u, TraceEventCount());
+
+  TraceStart();
+  {
+    TTraceScope s("work", "test", 42);
+  }
+  TraceStop();
+
+  EXPECT_EQ(1u, TraceEventCount());
+  std::string json = trace_json();
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"work\""));
+  EXPECT_NE(std::string::npos, json.find("\"args\":{\"n\":42}"));
+  EXPECT_NE(std::string::npos, json.find("\"ph\":\"X\""));
+  TraceClear();
+}
+
+TEST(TTrace, can_write_trace_file)
+{
+  TraceClear();
+  TraceStart();
+  {
+    TTraceScope s("work", "test", 0);
+  }
+  TraceStop();
+  const char* name = "test_ttrace_output.json";
+
+  ASSERT_TRUE(TraceWrite(name));
+  std::FILE* f = std::fopen(name, "r");
+  ASSERT_NE(nullptr, f);
+  char head[16] = {};
+  EXPECT_EQ(15u, std::fread(head, 1, 15, f));
+  std::fclose(f);
+  std::remove(name);
+  EXPECT_EQ(std::string("{\"traceEvents\":"), head);
+  TraceClear();
+}
+
+TEST(TTrace, write_keeps_stream_format)
+{
+  TraceClear();
+  TraceStart();
+  {
+    TTraceScope s("work", "test", 0);
+  }
+  TraceStop();
+  std::ostringstream out;
+  TraceWrite(out);
+  TraceClear();
+  out.str("");
+  out << 0.5;
+
+  EXPECT_EQ("0.5", out.str());
+}
+
+#ifdef TMATRIX_TRACE
+TEST(TTrace, records_operations_and_parallel_chunks)
+{
+  // встроенное ядро: системная BLAS частей цикла не записывает
+  TBlasBackend backend = BlasBackend();
+  SetBlasBackend(BLAS_BUILTIN);
+  const size_t ib = Tuning().multiply_rows;
+  TraceClear();
+  TraceStart();
+  TDynamicMatrix<double> a(100, FILL, 1.0), b(100, FILL, 2.0);
+  TDynamicMatrix<double> c = a * b;
+  TraceStop();
+  SetBlasBackend(backend);
+
+  std::string json = trace_json();
+  std::string chunk = "\"args\":{\"n\":" + std::to_string((100 + ib - 1) / ib) + "}";
+  size_t pos = json.find("\"name\":\"multiply rows\",\"cat\":\"chunk\"");
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"matrix*matrix\",\"cat\":\"op\""));
+  ASSERT_NE(std::string::npos, pos);
+  std::string event = json.substr(pos, json.find('}', pos) + 1 - pos);
+  EXPECT_NE(std::string::npos, event.find(chunk));
+  EXPECT_NE(std::string::npos, json.find("\"args\":{\"n\":100}"));
+  TraceClear();
+}
+#endif
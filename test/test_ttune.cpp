@@ -0,0 +1,194 @@
+#include "tautotune.h"
+#include "thalf.h"
+
+#include <gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+// восстанавливает параметры ядер после теста
+class TTuningGuard
+{
+  TTuning saved;
+public:
+  TTuningGuard() : saved(Tuning()) {}
+  ~TTuningGuard() { SetTuning(saved); }
+};
+
+static TTuning make_tuning(size_t rows, size_t depth, size_t cols)
+{
+  TTuning t = DefaultTuning();
+  t.multiply_rows = rows;
+  t.multiply_depth = depth;
+  t.multiply_cols = cols;
+  return t;
+}
+
+TEST(TTune, default_tuning_is_valid)
+{
+  TTuning t = DefaultTuning();
+
+  EXPECT_TRUE(TuningValid(t));
+  EXPECT_NE(0u, t.multiply_depth);
+  EXPECT_NE(0u, t.multiply_cols);
+}
+
+TEST(TTune, cache_sizes_are_ordered_when_known)
+{
+  TCacheInfo c = CacheSizes();
+
+  if (c.l1d != 0 && c.l2 != 0)
+  {
+    EXPECT_LE(c.l1d, c.l2);
+  }
+  if (c.l2 != 0 && c.l3 != 0)
+  {
+    EXPECT_LE(c.l2, c.l3);
+  }
+}
+
+TEST(TTune, throws_when_set_invalid_tuning)
+{
+  TTuningGuard guard;
+
+  ASSERT_ANY_THROW(SetTuning(make_tuning(0, 64, 64)));
+}
+
+TEST(TTune, can_save_and_load_tuning)
+{
+  const char* file = "test_ttune_tuning.txt";
+  TTuning t = make_tuning(3, 17, 0);
+  t.transpose_block = 24;
+  t.reduce_parallel_blocks = 5;
+  ASSERT_TRUE(SaveTuning(file, t));
+
+  TTuning r = DefaultTuning();
+  EXPECT_TRUE(LoadTuning(file, r));
+  EXPECT_EQ(3u, r.multiply_rows);
+  EXPECT_EQ(17u, r.multiply_depth);
+  EXPECT_EQ(0u, r.multiply_cols);
+  EXPECT_EQ(24u, r.transpose_block);
+  EXPECT_EQ(5u, r.reduce_parallel_blocks);
+  std::remove(file);
+}
+
+TEST(TTune, rejects_tuning_of_other_machine)
+{
+  const char* file = "test_ttune_other.txt";
+  {
+    std::ofstream f(file);
+    f << "signature cpu=other;l1d=1;l2=2;l3=3;threads=1\n"
+      << "multiply_rows 3\nmultiply_depth 17\nmultiply_cols 0\ntranspose_block 24\nreduce_parallel_blocks 5\n";
+  }
+  TTuning r = DefaultTuning();
+
+  EXPECT_FALSE(LoadTuning(file, r));
+  EXPECT_EQ(DefaultTuning().multiply_rows, r.multiply_rows);
+  std::remove(file);
+}
+
+TEST(TTune, rejects_incomplete_tuning_file)
+{
+  const char* file = "test_ttune_incomplete.txt";
+  {
+    std::ofstream f(file);
+    f << "signature " << TuningSignature() << "\nmultiply_rows 3\n";
+  }
+  TTuning r;
+
+  EXPECT_FALSE(LoadTuning(file, r));
+  EXPECT_FALSE(LoadTuning("test_ttune_missing.txt", r));
+  std::remove(file);
+}
+
+TEST(TTune, rejects_tuning_file_with_huge_blocks)
+{
+  const char* file = "test_ttune_huge.txt";
+  const char* lines[3] = { "multiply_rows 100000000\nmultiply_depth 17\ntranspose_block 24\n",
+    "multiply_rows 3\nmultiply_depth 100000000\ntranspose_block 24\n",
+    "multiply_rows 3\nmultiply_depth 17\ntranspose_block 100000000\n" };
+  for (const char* l : lines)
+  {
+    {
+      std::ofstream f(file);
+      f << "signature " << TuningSignature() << "\n" << l << "multiply_cols 0\nreduce_parallel_blocks 5\n";
+    }
+    TTuning r = DefaultTuning();
+
+    EXPECT_FALSE(LoadTuning(file, r));
+    EXPECT_EQ(DefaultTuning().multiply_rows, r.multiply_rows);
+  }
+  std::remove(file);
+}
+
+TEST(TTune, throws_when_set_huge_blocks)
+{
+  TTuningGuard guard;
+
+  ASSERT_ANY_THROW(SetTuning(make_tuning(100000000, 64, 64)));
+  ASSERT_ANY_THROW(SetTuning(make_tuning(8, 64, TUNING_MAX_BLOCK + 1)));
+}
+
+TEST(TTune, multiply_result_does_not_depend_on_blocks)
+{
+  TTuningGuard guard;
+  TBlasBackend backend = BlasBackend();
+  SetBlasBackend(BLAS_BUILTIN);
+  const size_t n = 77;
+  TDynamicMatrix<double> a(n, GENERATE, [](size_t i, size_t j) { return double((i * 31 + j * 17) % 13) / 7 - 0.8; });
+  TDynamicMatrix<double> b(n, GENERATE, [](size_t i, size_t j) { return double((i * 11 + j * 23) % 19) / 9 - 1.1; });
+  SetTuning(make_tuning(1, 0, 0));
+  TDynamicMatrix<double> expected = a * b;
+
+  SetTuning(make_tuning(5, 16, 24));
+  EXPECT_EQ(expected, a * b);
+  SetTuning(make_tuning(64, 100, 7));
+  EXPECT_EQ(expected, a * b);
+  SetBlasBackend(backend);
+}
+
+TEST(TTune, blocked_multiply_works_with_wide_accumulator)
+{
+  TTuningGuard guard;
+  const size_t n = 9;
+  TDynamicMatrix<THalf> a(n, GENERATE, [](size_t i, size_t j) { return THalf(float((i + 2 * j) % 5) / 4); });
+  TDynamicMatrix<THalf> b(n, GENERATE, [](size_t i, size_t j) { return THalf(float((3 * i + j) % 7) / 8); });
+  SetTuning(make_tuning(1, 0, 0));
+  TDynamicMatrix<THalf> plain = a * b;
+
+  SetTuning(make_tuning(2, 4, 3));
+  TDynamicMatrix<THalf> blocked = a * b;
+
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      EXPECT_EQ(float(plain[i][j]), float(blocked[i][j]));
+}
+
+TEST(TTune, can_transpose_matrix)
+{
+  TTuningGuard guard;
+  TTuning t = DefaultTuning();
+  t.transpose_block = 4;
+  SetTuning(t);
+  const size_t n = 10;
+  TDynamicMatrix<int> m(n, GENERATE, [](size_t i, size_t j) { return int(i * 100 + j); });
+
+  TDynamicMatrix<int> r = m.transpose();
+
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      EXPECT_EQ(m[i][j], r[j][i]);
+}
+
+TEST(TTune, autotune_sets_valid_tuning)
+{
+  TTuningGuard guard;
+  TBlasBackend backend = BlasBackend();
+
+  TTuning t = Autotune(48, 1);
+
+  EXPECT_TRUE(TuningValid(t));
+  EXPECT_EQ(t.multiply_rows, Tuning().multiply_rows);
+  EXPECT_EQ(t.transpose_block, Tuning().transpose_block);
+  EXPECT_EQ(backend, BlasBackend().load());
+}
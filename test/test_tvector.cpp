@@ -1,5 +1,10 @@
 #include "tmatrix.h"
 
+#include <numeric>
+#if __has_include(<execution>)
+#include <execution>
+#endif
+
 #include <gtest.h>
 
 TEST(TDynamicVector, can_create_vector_with_positive_length)
@@ -139,3 +144,308 @@ TEST(TDynamicVector, cant_multiply_vectors_with_not_equal_size)
   ADD_FAILURE();
 }
 
+
+TEST(TDynamicVector, can_compute_sum_min_and_max)
+{
+  TDynamicVector<int> v(10000);
+  for (size_t i = 0; i < v.size(); i++)
+    v[i] = int(i % 100) - 30;
+
+  EXPECT_EQ(195000, v.sum());
+  EXPECT_EQ(-30, v.min());
+  EXPECT_EQ(69, v.max());
+}
+
+TEST(TDynamicVector, dot_product_of_large_vectors_is_exact_for_integers)
+{
+  TDynamicVector<long long> a(50000), b(50000);
+  long long expected = 0;
+  for (size_t i = 0; i < a.size(); i++)
+  {
+    a[i] = (long long)(i % 7);
+    b[i] = (long long)(i % 11);
+    expected += a[i] * b[i];
+  }
+
+  EXPECT_EQ(expected, a * b);
+}
+
+TEST(TDynamicVector, floating_dot_product_does_not_depend_on_thread_count)
+{
+  TDynamicVector<double> a(100000), b(100000);
+  for (size_t i = 0; i < a.size(); i++)
+  {
+    a[i] = 1.0 / double(i + 1);
+    b[i] = double(i % 13) - 6.5;
+  }
+  double r1 = a * b;
+#ifdef _OPENMP
+  int threads = omp_get_max_threads();
+  omp_set_num_threads(threads > 1 ? 1 : 4);
+  double r2 = a * b;
+  omp_set_num_threads(threads);
+#else
+  double r2 = a * b;
+#endif
+
+  EXPECT_EQ(r1, r2);
+}
+
+TEST(TDynamicVector, can_find_argmin_and_argmax)
+{
+  TDynamicVector<int> v(20000);
+  v[12345] = 9;
+  v[15000] = 9;
+  v[77] = -4;
+
+  EXPECT_EQ(12345u, v.argmax());
+  EXPECT_EQ(77u, v.argmin());
+}
+
+TEST(TDynamicVector, can_compute_norms)
+{
+  TDynamicVector<double> v(2);
+  v[0] = 3;
+  v[1] = -4;
+
+  EXPECT_EQ(7, v.norm1());
+  EXPECT_EQ(5, v.norm2());
+  EXPECT_EQ(4, v.norm_inf());
+}
+
+TEST(TDynamicVector, large_vectors_differing_in_last_element_are_not_equal)
+{
+  TDynamicVector<int> a(100000), b(100000);
+  EXPECT_TRUE(a == b);
+  b[b.size() - 1] = 1;
+
+  EXPECT_FALSE(a == b);
+}
+
+TEST(TDynamicVector, approx_equal_uses_absolute_and_relative_tolerance)
+{
+  TDynamicVector<double> a(2), b(2);
+  a[0] = 1.0;  b[0] = 1.05;
+  a[1] = 1e6;  b[1] = 1e6 + 50;
+
+  EXPECT_FALSE(a.approx_equal(b, 0.1));
+  EXPECT_TRUE(a.approx_equal(b, 0.1, 1e-4));
+  EXPECT_FALSE(a.approx_equal(b, 0.01, 1e-4));
+}
+
+TEST(TDynamicVector, approx_equal_can_compare_in_ulps)
+{
+  TDynamicVector<float> a(3), b(3);
+  a[0] = 1.0f;  b[0] = std::nextafter(std::nextafter(1.0f, 2.0f), 2.0f);
+  a[1] = -0.0f; b[1] = 0.0f;
+  a[2] = 2.0f;  b[2] = std::nextafter(2.0f, 0.0f);
+
+  EXPECT_TRUE(a.approx_equal(b, 0.0f, 0.0f, 2));
+  EXPECT_FALSE(a.approx_equal(b, 0.0f, 0.0f, 1));
+}
+
+TEST(TDynamicVector, elements_are_cache_line_aligned)
+{
+  for (size_t n = 1; n < 100; n += 7)
+  {
+    TDynamicVector<char> v(n);
+
+    EXPECT_EQ(0u, (size_t)&v[0] % ALLOC_ALIGNMENT);
+  }
+}
+
+TEST(TDynamicVector, can_create_large_vector_with_any_huge_page_mode)
+{
+  THugePageMode modes[] = { HUGE_PAGES_OFF, HUGE_PAGES_EXPLICIT, HUGE_PAGES_ADVISE };
+  for (THugePageMode mode : modes)
+  {
+    SetHugePageMode(mode);
+    TDynamicVector<double> v(HUGE_PAGE_SIZE / sizeof(double) * 2 + 3);
+    v[v.size() - 1] = 1;
+
+    EXPECT_EQ(0u, (size_t)&v[0] % ALLOC_ALIGNMENT);
+    EXPECT_EQ(1, v.sum());
+  }
+}
+
+TEST(TDynamicVector, can_create_vector_filled_with_value)
+{
+  TDynamicVector<int> v(5, FILL, 7);
+
+  EXPECT_EQ(35, v.sum());
+}
+
+TEST(TDynamicVector, can_create_vector_from_generator)
+{
+  TDynamicVector<size_t> v(4, GENERATE, [](size_t i) { return i * i; });
+
+  EXPECT_EQ(9u, v[3]);
+}
+
+TEST(TDynamicVector, can_create_uninitialized_vector)
+{
+  TDynamicVector<double> v(3, UNINITIALIZED);
+  v[0] = v[1] = v[2] = 1.5;
+
+  EXPECT_EQ(3u, v.size());
+  EXPECT_EQ(4.5, v.sum());
+}
+
+TEST(TDynamicVector, throws_when_create_uninitialized_vector_with_zero_length)
+{
+  ASSERT_ANY_THROW(TDynamicVector<int> v(0, UNINITIALIZED));
+}
+
+TEST(TDynamicVector, chained_operations_reuse_temporary_buffer)
+{
+  TDynamicVector<int> a(4, FILL, 1), b(4, FILL, 2), c(4, FILL, 3);
+  TDynamicVector<int> t = a + b;
+  const int* p = &t[0];
+  TDynamicVector<int> d = (std::move(t) + c) * 2 - 1;
+
+  EXPECT_EQ(p, &d[0]);
+  EXPECT_EQ(44, d.sum());
+}
+
+TEST(TDynamicVector, subtraction_from_temporary_keeps_operand_order)
+{
+  TDynamicVector<int> a(3, FILL, 10), b(3, FILL, 4), c(3, FILL, 1);
+  TDynamicVector<int> t = b - c;
+  const int* p = &t[0];
+  TDynamicVector<int> d = a - std::move(t);
+
+  EXPECT_EQ(p, &d[0]);
+  EXPECT_EQ(21, d.sum());
+  EXPECT_EQ(TDynamicVector<int>(3, FILL, 0), (a - b) - (b + b - c - c));
+}
+
+TEST(TDynamicVector, throws_when_add_temporary_vectors_with_not_equal_size)
+{
+  TDynamicVector<int> a(3), b(4);
+
+  ASSERT_ANY_THROW(TDynamicVector<int>(a) + TDynamicVector<int>(b));
+}
+
+TEST(TDynamicVector, at_checks_index_in_every_build)
+{
+  TDynamicVector<int> v(3);
+
+  ASSERT_THROW(v.at(3), out_of_range);
+  ASSERT_NO_THROW(v.at(2));
+}
+
+#if TMATRIX_BOUNDS_CHECK == TMATRIX_BOUNDS_ALL
+TEST(TDynamicVector, index_operator_is_checked_in_debug_build)
+{
+  TDynamicVector<int> v(3);
+  const TDynamicVector<int>& c = v;
+
+  ASSERT_THROW(v[3], out_of_range);
+  ASSERT_THROW(c[(size_t)-1], out_of_range);
+}
+#endif
+
+#if TMATRIX_BOUNDS_CHECK == TMATRIX_BOUNDS_SAMPLE
+TEST(TDynamicVector, sampled_index_check_catches_repeated_bad_access)
+{
+  TDynamicVector<int> v(3);
+  bool caught = false;
+  for (int k = 0; k < TMATRIX_BOUNDS_SAMPLE_PERIOD && !caught; k++)
+  {
+    try { (void)v[3]; }
+    catch (const out_of_range&) { caught = true; }
+  }
+
+  EXPECT_TRUE(caught);
+}
+#endif
+
+TEST(TDynamicVector, works_with_standard_algorithms)
+{
+  TDynamicVector<int> v(5, GENERATE, [](size_t i) { return int(5 - i); });
+  std::sort(v.begin(), v.end());
+
+  EXPECT_EQ(1, v[0]);
+  EXPECT_EQ(5, v[4]);
+  EXPECT_EQ(15, std::accumulate(v.cbegin(), v.cend(), 0));
+  EXPECT_EQ(v.data() + 5, v.end());
+}
+
+#ifdef __cpp_lib_parallel_algorithm
+TEST(TDynamicVector, works_with_parallel_algorithms)
+{
+  TDynamicVector<double> v(100000, FILL, 1.0), w(100000);
+  std::transform(std::execution::par_unseq, v.begin(), v.end(), w.begin(), [](double x) { return 2 * x; });
+
+  EXPECT_EQ(200000.0, std::reduce(std::execution::par_unseq, w.begin(), w.end(), 0.0));
+}
+#endif
+
+TEST(TDynamicVector, view_shares_external_buffer)
+{
+  int buf[4] = { 1, 2, 3, 4 };
+  TDynamicVector<int> v(buf, 4, VIEW);
+  v[0] = 10;
+
+  EXPECT_EQ(10, buf[0]);
+  EXPECT_EQ(buf, v.data());
+  EXPECT_FALSE(v.owns());
+  ASSERT_ANY_THROW(TDynamicVector<int>(nullptr, 4, VIEW));
+}
+
+TEST(TDynamicVector, copy_of_view_owns_its_memory)
+{
+  int buf[3] = { 1, 2, 3 };
+  TDynamicVector<int> v(buf, 3, VIEW);
+  TDynamicVector<int> c(v);
+  c[0] = 5;
+
+  EXPECT_TRUE(c.owns());
+  EXPECT_EQ(1, buf[0]);
+}
+
+TEST(TDynamicVector, operations_on_temporary_view_do_not_modify_buffer)
+{
+  int buf[3] = { 1, 2, 3 };
+  TDynamicVector<int> v = TDynamicVector<int>(buf, 3, VIEW) * 2 + 1;
+
+  EXPECT_EQ(15, v.sum());
+  EXPECT_EQ(1, buf[0]);
+  EXPECT_TRUE(v.owns());
+}
+
+TEST(TDynamicVector, adopted_buffer_is_released_by_deleter)
+{
+  int released = 0;
+  {
+    TDynamicVector<double> v(new double[3](), 3, ADOPT, [&released](double* p) { delete[] p; released++; });
+    v[2] = 1.5;
+    TDynamicVector<double> w(std::move(v));
+
+    EXPECT_EQ(1.5, w.sum());
+    EXPECT_TRUE(w.owns());
+  }
+  EXPECT_EQ(1, released);
+}
+
+TEST(TDynamicVector, adopted_buffer_is_released_when_constructor_throws)
+{
+  int released = 0;
+
+  ASSERT_ANY_THROW(TDynamicVector<int>(new int[1], 0, ADOPT, [&released](int* p) { delete[] p; released++; }));
+  EXPECT_EQ(1, released);
+}
+
+#ifdef __cpp_lib_span
+TEST(TDynamicVector, converts_to_and_from_span)
+{
+  int buf[3] = { 1, 2, 3 };
+  TDynamicVector<int> v(std::span<int>(buf), VIEW);
+  std::span<int> s = v;
+  const TDynamicVector<int>& c = v;
+  std::span<const int> cs = c;
+
+  EXPECT_EQ(buf, s.data());
+  EXPECT_EQ(3u, cs.size());
+}
+#endif